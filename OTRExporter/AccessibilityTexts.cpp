@@ -0,0 +1,96 @@
+#include "AccessibilityTexts.h"
+#include "MessageTable.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <charconv>
+#include <string>
+
+struct AccessibilityText {
+    std::string key;
+    uint32_t numericKey = 0;
+    std::string value;
+};
+
+// Keys with leading zeros are not numeric, "01" and "1" would otherwise both be key 1
+static bool ParseNumericKey(const std::string& key, uint32_t& value)
+{
+    if (key.empty() || (key.size() > 1 && key[0] == '0'))
+        return false;
+
+    auto result = std::from_chars(key.data(), key.data() + key.size(), value);
+
+    return result.ec == std::errc() && result.ptr == key.data() + key.size();
+}
+
+bool CompileAccessibilityTexts(const std::vector<char>& json, std::vector<char>& table)
+{
+    nlohmann::json root = nlohmann::json::parse(json.begin(), json.end(), nullptr, false, true);
+
+    if (root.is_discarded() || !root.is_object())
+        return false;
+
+    std::vector<AccessibilityText> texts;
+    bool numeric = true;
+
+    for (const auto& item : root.items()) {
+        if (!item.value().is_string())
+            return false;
+
+        AccessibilityText text;
+        text.key = item.key();
+        text.value = item.value().get<std::string>();
+
+        numeric &= ParseNumericKey(text.key, text.numericKey);
+        texts.push_back(std::move(text));
+    }
+
+    std::sort(texts.begin(), texts.end(), [&](const AccessibilityText& a, const AccessibilityText& b) {
+        return numeric ? a.numericKey < b.numericKey : a.key < b.key;
+    });
+
+    // Strings are NUL terminated; the blob builder stores identical strings once
+    std::vector<std::string> strings;
+
+    for (const auto& text : texts) {
+        if (!numeric)
+            strings.push_back(text.key + '\0');
+
+        strings.push_back(text.value + '\0');
+    }
+
+    std::vector<char> blob;
+    std::vector<MessageString> placed = BuildMessageBlob(strings, true, blob);
+
+    MemoryStream* stream = new MemoryStream();
+    BinaryWriter writer = BinaryWriter(stream);
+
+    writer.Write((uint32_t)ACCESSIBILITY_TEXTS_MAGIC);
+    writer.Write((uint32_t)ACCESSIBILITY_TEXTS_VERSION);
+    writer.Write((uint32_t)(numeric ? ACCESSIBILITY_TEXTS_KEY_NUMERIC : ACCESSIBILITY_TEXTS_KEY_STRING));
+    writer.Write((uint32_t)texts.size());
+    writer.Write((uint32_t)blob.size());
+
+    size_t index = 0;
+
+    for (const auto& text : texts) {
+        if (numeric) {
+            writer.Write(text.numericKey);
+            writer.Write((uint32_t)0);
+        } else {
+            writer.Write(placed[index].offset);
+            writer.Write(placed[index].length - 1);
+            index++;
+        }
+
+        writer.Write(placed[index].offset);
+        writer.Write(placed[index].length - 1);
+        index++;
+    }
+
+    writer.Write(blob.data(), blob.size());
+
+    table = stream->ToVector();
+    return true;
+}
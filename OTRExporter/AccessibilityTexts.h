@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Compiled form of the accessibility text files (assets/accessibility/texts/*.json), so the game can look texts up
+// without a JSON parser:
+//   u32 magic 'ATXT', u32 version, u32 key type, u32 entry count, u32 blob size
+//   entry table sorted by key: u32 key, u32 key length, u32 value offset, u32 value length
+//   UTF-8 blob
+// Files whose keys are all decimal numbers without leading zeros (scene names) use ACCESSIBILITY_TEXTS_KEY_NUMERIC
+// and store the number as the key. Other files use ACCESSIBILITY_TEXTS_KEY_STRING, the key is then the blob offset of
+// the key string and the table is sorted by its bytes. Every string in the blob is followed by a NUL byte, which the
+// lengths leave out, so both forms can be used in place.
+
+#define ACCESSIBILITY_TEXTS_MAGIC 0x41545854
+#define ACCESSIBILITY_TEXTS_VERSION 0
+#define ACCESSIBILITY_TEXTS_KEY_NUMERIC 0
+#define ACCESSIBILITY_TEXTS_KEY_STRING 1
+
+// Compiles a text file into `table`. Comments are allowed. Returns false if the file is not an object of strings.
+bool CompileAccessibilityTexts(const std::vector<char>& json, std::vector<char>& table);
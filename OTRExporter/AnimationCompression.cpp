@@ -0,0 +1,264 @@
+#include "AnimationCompression.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+bool CompressNormalAnimation(const std::vector<int16_t>& frameData, const std::vector<uint16_t>& jointIndices,
+                             uint16_t staticIndexMax, uint16_t frameCount, CompressedNormalAnimation& anim)
+{
+    if (frameCount == 0)
+        return false;
+
+    // Gather the values every joint axis reads over the whole animation
+    std::vector<std::vector<int16_t>> tracks;
+
+    for (uint16_t index : jointIndices) {
+        std::vector<int16_t> track;
+
+        if (index < staticIndexMax) {
+            if (index >= frameData.size())
+                return false;
+
+            track.assign(frameCount, frameData[index]);
+        } else {
+            if ((size_t)index + frameCount > frameData.size())
+                return false;
+
+            track.assign(frameData.begin() + index, frameData.begin() + index + frameCount);
+        }
+
+        tracks.push_back(track);
+    }
+
+    anim = CompressedNormalAnimation();
+    anim.frameCount = frameCount;
+
+    std::map<int16_t, uint16_t> constIndices;
+    std::map<std::vector<int16_t>, uint32_t> narrowIndices;
+    std::map<std::vector<int16_t>, uint32_t> wideIndices;
+    std::vector<const std::vector<int16_t>*> narrowTracks;
+    std::vector<const std::vector<int16_t>*> wideTracks;
+
+    for (const auto& track : tracks) {
+        bool constant = true;
+        bool narrow = true;
+
+        for (size_t f = 1; f < track.size(); f++) {
+            int16_t delta = (int16_t)(uint16_t)(track[f] - track[f - 1]);
+
+            constant &= delta == 0;
+            narrow &= delta >= INT8_MIN && delta <= INT8_MAX;
+        }
+
+        if (constant) {
+            if (constIndices.emplace(track[0], (uint16_t)anim.constValues.size()).second)
+                anim.constValues.push_back(track[0]);
+        } else if (narrow) {
+            auto result = narrowIndices.emplace(track, (uint32_t)narrowTracks.size());
+
+            if (result.second)
+                narrowTracks.push_back(&result.first->first);
+        } else {
+            auto result = wideIndices.emplace(track, (uint32_t)wideTracks.size());
+
+            if (result.second)
+                wideTracks.push_back(&result.first->first);
+        }
+    }
+
+    anim.narrowCount = (uint32_t)narrowTracks.size();
+    anim.wideCount = (uint32_t)wideTracks.size();
+
+    size_t constCount = anim.constValues.size();
+
+    if (constCount + anim.narrowCount + anim.wideCount > UINT16_MAX)
+        return false;
+
+    for (const auto& track : tracks) {
+        auto constIt = constIndices.find(track[0]);
+        auto narrowIt = narrowIndices.find(track);
+        auto wideIt = wideIndices.find(track);
+
+        if (narrowIt != narrowIndices.end())
+            anim.trackIndices.push_back((uint16_t)(constCount + narrowIt->second));
+        else if (wideIt != wideIndices.end())
+            anim.trackIndices.push_back((uint16_t)(constCount + anim.narrowCount + wideIt->second));
+        else
+            anim.trackIndices.push_back(constIt->second);
+    }
+
+    for (const auto* track : narrowTracks)
+        anim.baseValues.push_back((*track)[0]);
+
+    for (const auto* track : wideTracks)
+        anim.baseValues.push_back((*track)[0]);
+
+    for (uint16_t f = 1; f < frameCount; f++) {
+        for (const auto* track : narrowTracks)
+            anim.narrowDeltas.push_back((int8_t)(int16_t)(uint16_t)((*track)[f] - (*track)[f - 1]));
+
+        for (const auto* track : wideTracks)
+            anim.wideValues.push_back((*track)[f]);
+    }
+
+    return true;
+}
+
+std::vector<int16_t> DecodeNormalAnimation(const CompressedNormalAnimation& anim)
+{
+    size_t axisCount = anim.trackIndices.size();
+    size_t constCount = anim.constValues.size();
+
+    std::vector<int16_t> current = anim.baseValues;
+    std::vector<int16_t> frames(anim.frameCount * axisCount);
+
+    for (size_t f = 0; f < anim.frameCount; f++) {
+        if (f != 0) {
+            for (size_t t = 0; t < anim.narrowCount; t++)
+                current[t] = (int16_t)(uint16_t)(current[t] + anim.narrowDeltas[(f - 1) * anim.narrowCount + t]);
+
+            for (size_t t = 0; t < anim.wideCount; t++)
+                current[anim.narrowCount + t] = anim.wideValues[(f - 1) * anim.wideCount + t];
+        }
+
+        for (size_t i = 0; i < axisCount; i++) {
+            uint16_t index = anim.trackIndices[i];
+
+            frames[f * axisCount + i] = index < constCount ? anim.constValues[index] : current[index - constCount];
+        }
+    }
+
+    return frames;
+}
+
+std::vector<int16_t> EvaluateNormalAnimation(const std::vector<int16_t>& frameData,
+                                             const std::vector<uint16_t>& jointIndices, uint16_t staticIndexMax,
+                                             uint16_t frameCount)
+{
+    std::vector<int16_t> frames;
+
+    for (size_t f = 0; f < frameCount; f++) {
+        for (uint16_t index : jointIndices)
+            frames.push_back(index >= staticIndexMax ? frameData[index + f] : frameData[index]);
+    }
+
+    return frames;
+}
+
+bool CompressPlayerAnimation(const std::vector<int16_t>& limbRotData, uint32_t frameCount, uint32_t checkpointInterval,
+                             CompressedPlayerAnimation& anim)
+{
+    if (frameCount == 0 || checkpointInterval == 0 || limbRotData.size() % frameCount != 0)
+        return false;
+
+    anim = CompressedPlayerAnimation();
+    anim.frameCount = frameCount;
+    anim.valuesPerFrame = (uint32_t)(limbRotData.size() / frameCount);
+    anim.checkpointInterval = checkpointInterval;
+
+    for (uint32_t checkpoint = 0; checkpoint < frameCount; checkpoint += checkpointInterval) {
+        const int16_t* checkpointRow = &limbRotData[checkpoint * anim.valuesPerFrame];
+        uint32_t spanEnd = std::min(checkpoint + checkpointInterval, frameCount);
+        std::vector<int16_t> deltas;
+
+        anim.checkpointValues.insert(anim.checkpointValues.end(), checkpointRow, checkpointRow + anim.valuesPerFrame);
+
+        for (uint32_t f = checkpoint + 1; f < spanEnd; f++) {
+            const int16_t* row = &limbRotData[f * anim.valuesPerFrame];
+            const int16_t* prevRow = row - anim.valuesPerFrame;
+
+            for (uint32_t i = 0; i < anim.valuesPerFrame; i++)
+                deltas.push_back((int16_t)(uint16_t)(row[i] - prevRow[i]));
+        }
+
+        bool narrow = std::all_of(deltas.begin(), deltas.end(),
+                                  [](int16_t delta) { return delta >= INT8_MIN && delta <= INT8_MAX; });
+
+        if (!narrow && anim.deltaStream.size() % 2 != 0)
+            anim.deltaStream.push_back(0);
+
+        anim.checkpointOffsets.push_back((uint32_t)anim.deltaStream.size());
+        anim.spanWidths.push_back(narrow ? 1 : 2);
+
+        for (int16_t delta : deltas) {
+            if (narrow) {
+                anim.deltaStream.push_back((uint8_t)(int8_t)delta);
+            } else {
+                anim.deltaStream.push_back((uint8_t)(delta & 0xFF));
+                anim.deltaStream.push_back((uint8_t)((uint16_t)delta >> 8));
+            }
+        }
+    }
+
+    return true;
+}
+
+void DecodePlayerAnimationFrame(const CompressedPlayerAnimation& anim, uint32_t frame, int16_t* values)
+{
+    uint32_t checkpoint = frame / anim.checkpointInterval;
+    const int16_t* checkpointRow = &anim.checkpointValues[checkpoint * anim.valuesPerFrame];
+    const uint8_t* stream = anim.deltaStream.data() + anim.checkpointOffsets[checkpoint];
+    uint32_t rowCount = frame - checkpoint * anim.checkpointInterval;
+
+    std::copy(checkpointRow, checkpointRow + anim.valuesPerFrame, values);
+
+    // Fixed width rows, so the compiler vectorizes both loops the way a runtime decoder would
+    if (anim.spanWidths[checkpoint] == 1) {
+        const int8_t* deltas = (const int8_t*)stream;
+
+        for (uint32_t f = 0; f < rowCount; f++, deltas += anim.valuesPerFrame) {
+            for (uint32_t i = 0; i < anim.valuesPerFrame; i++)
+                values[i] = (int16_t)(uint16_t)(values[i] + deltas[i]);
+        }
+    } else {
+        std::vector<int16_t> deltas(anim.valuesPerFrame);
+
+        for (uint32_t f = 0; f < rowCount; f++, stream += anim.valuesPerFrame * sizeof(int16_t)) {
+            std::memcpy(deltas.data(), stream, anim.valuesPerFrame * sizeof(int16_t));
+
+            for (uint32_t i = 0; i < anim.valuesPerFrame; i++)
+                values[i] = (int16_t)(uint16_t)(values[i] + deltas[i]);
+        }
+    }
+}
+
+std::vector<int16_t> DecodePlayerAnimation(const CompressedPlayerAnimation& anim)
+{
+    std::vector<int16_t> frames(anim.frameCount * anim.valuesPerFrame);
+
+    for (uint32_t f = 0; f < anim.frameCount; f++)
+        DecodePlayerAnimationFrame(anim, f, &frames[f * anim.valuesPerFrame]);
+
+    return frames;
+}
+
+std::vector<float> BuildKeyFrameHermiteCoefficients(const std::vector<int16_t>& frames,
+                                                    const std::vector<int16_t>& values,
+                                                    const std::vector<int16_t>& velocities,
+                                                    const std::vector<uint32_t>& trackOffsets)
+{
+    std::vector<float> coefficients(frames.size() * 4, 0.0f);
+
+    for (size_t t = 0; t + 1 < trackOffsets.size(); t++) {
+        for (uint32_t k = trackOffsets[t]; k < trackOffsets[t + 1]; k++) {
+            float* curve = &coefficients[k * 4];
+            float x0 = values[k];
+
+            curve[0] = x0;
+
+            if (k + 1 == trackOffsets[t + 1] || frames[k + 1] == frames[k])
+                continue;
+
+            float x1 = values[k + 1];
+            float delta = (frames[k + 1] - frames[k]) / KEYFRAME_FRAMES_PER_SECOND;
+            float v0 = velocities[k] * delta;
+            float v1 = velocities[k + 1] * delta;
+
+            curve[1] = v0;
+            curve[2] = 3.0f * (x1 - x0) - 2.0f * v0 - v1;
+            curve[3] = 2.0f * (x0 - x1) + v0 + v1;
+        }
+    }
+
+    return coefficients;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed layout for normal (frame table) animations.
+//
+// Every joint axis reads one track. Identical tracks are stored once, tracks that never change are stored as a
+// single constant and animated tracks are split by how far their values move between frames. Narrow tracks store
+// s8 deltas from the previous frame, wide tracks store their s16 values as is.
+//
+// The narrow and wide streams are each a structure of arrays with one lane per joint axis track, stored frame by
+// frame. The game evaluates every joint at one frame, and narrow tracks are decoded by summing deltas over the
+// frames, so the SIMD lanes run across tracks. With this layout, advancing all tracks by one frame is one
+// contiguous vector add. With one array per track, each track's prefix sum would be a serial dependency chain.
+struct CompressedNormalAnimation {
+    uint16_t frameCount = 0;
+    // Per joint axis: < constValues.size() selects a constant, otherwise an animated track (narrow tracks first)
+    std::vector<uint16_t> trackIndices;
+    std::vector<int16_t> constValues;
+    uint32_t narrowCount = 0;
+    uint32_t wideCount = 0;
+    // Frame 0 value of each animated track
+    std::vector<int16_t> baseValues;
+    // (frameCount - 1) * narrowCount deltas, frame-major
+    std::vector<int8_t> narrowDeltas;
+    // (frameCount - 1) * wideCount values, frame-major
+    std::vector<int16_t> wideValues;
+};
+
+// Builds the compressed form of a normal animation. `frameData` and `jointIndices` (three per joint) are the
+// animation's frame table and joint index table, `staticIndexMax` the index below which an entry is static.
+// Returns false if the tables reference data outside the frame table or there are too many tracks.
+bool CompressNormalAnimation(const std::vector<int16_t>& frameData, const std::vector<uint16_t>& jointIndices,
+                             uint16_t staticIndexMax, uint16_t frameCount, CompressedNormalAnimation& anim);
+
+// Reference decoder. Returns frameCount rows of one value per joint axis, the same values the game reads from the
+// uncompressed tables.
+std::vector<int16_t> DecodeNormalAnimation(const CompressedNormalAnimation& anim);
+
+// Evaluates the uncompressed tables the way the game does, in the same layout as DecodeNormalAnimation.
+std::vector<int16_t> EvaluateNormalAnimation(const std::vector<int16_t>& frameData,
+                                             const std::vector<uint16_t>& jointIndices, uint16_t staticIndexMax,
+                                             uint16_t frameCount);
+
+// Compressed layout for player animations.
+//
+// Player animations are rows of `valuesPerFrame` s16 values, one row per frame. Every `checkpointInterval` frames
+// the full row is stored as is. The frames after a checkpoint (a span) are stored as rows of differences from the
+// previous frame's values. Every value in a span uses the same width: s8 if all of the span's differences fit,
+// otherwise s16, with the span starting on a 2 byte boundary. A frame is decoded by starting at the checkpoint at or
+// before it and adding the following rows. Each row is fixed width, so a SIMD decoder loads a row, sign-extends it
+// and adds it to the current values, several values per instruction.
+struct CompressedPlayerAnimation {
+    uint32_t frameCount = 0;
+    uint32_t valuesPerFrame = 0;
+    uint32_t checkpointInterval = 0;
+    // Start of the frames following each checkpoint in deltaStream
+    std::vector<uint32_t> checkpointOffsets;
+    // Bytes per difference of each checkpoint's span, 1 or 2
+    std::vector<uint8_t> spanWidths;
+    // valuesPerFrame values per checkpoint
+    std::vector<int16_t> checkpointValues;
+    std::vector<uint8_t> deltaStream;
+};
+
+bool CompressPlayerAnimation(const std::vector<int16_t>& limbRotData, uint32_t frameCount, uint32_t checkpointInterval,
+                             CompressedPlayerAnimation& anim);
+
+// Reference decoders. DecodePlayerAnimationFrame decodes one row starting from the nearest checkpoint,
+// DecodePlayerAnimation returns all rows in the uncompressed layout.
+void DecodePlayerAnimationFrame(const CompressedPlayerAnimation& anim, uint32_t frame, int16_t* values);
+std::vector<int16_t> DecodePlayerAnimation(const CompressedPlayerAnimation& anim);
+
+// Keyframe animations (MM) interpolate each track with a cubic Hermite curve between consecutive keyframes. The
+// runtime scales velocities by the time between keyframes in seconds.
+#define KEYFRAME_FRAMES_PER_SECOND 30.0f
+
+// Precomputed curve for every keyframe of every track: four floats (a, b, c, d) such that the value between
+// keyframe k and k + 1 is a + b*t + c*t^2 + d*t^3, with t going from 0 to 1. The last keyframe of a track holds
+// its value. `trackOffsets` holds the first keyframe of each track plus one final end offset.
+std::vector<float> BuildKeyFrameHermiteCoefficients(const std::vector<int16_t>& frames,
+                                                    const std::vector<int16_t>& values,
+                                                    const std::vector<int16_t>& velocities,
+                                                    const std::vector<uint32_t>& trackOffsets);
@@ -7,18 +7,88 @@
 
 #include <Globals.h>
 #include "DisplayListExporter.h"
+#include "AnimationCompression.h"
+#include "Main.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #undef FindResource
 
+// Time spent in the reference decoder and in evaluating the uncompressed tables, for PrintDecodeStats
+static std::atomic<uint64_t> decodedValues = 0;
+static std::atomic<uint64_t> decodeNanoseconds = 0;
+static std::atomic<uint64_t> evaluateNanoseconds = 0;
+
+// Compresses the frame table of a normal animation and checks that every frame decodes to the original values.
+// Falls back to the legacy layout if that fails or the result would not be smaller.
+static bool CompressAnimation(ZNormalAnimation* normalAnim, CompressedNormalAnimation& compressed)
+{
+	std::vector<int16_t> frameData(normalAnim->rotationValues.begin(), normalAnim->rotationValues.end());
+	std::vector<uint16_t> jointIndices;
+
+	for (const auto& index : normalAnim->rotationIndices)
+	{
+		jointIndices.push_back(index.x);
+		jointIndices.push_back(index.y);
+		jointIndices.push_back(index.z);
+	}
+
+	uint16_t frameCount = (uint16_t)normalAnim->frameCount;
+	uint16_t staticIndexMax = (uint16_t)normalAnim->limit;
+
+	if (!CompressNormalAnimation(frameData, jointIndices, staticIndexMax, frameCount, compressed))
+		return false;
+
+	auto decodeStart = std::chrono::steady_clock::now();
+	std::vector<int16_t> decoded = DecodeNormalAnimation(compressed);
+	auto evaluateStart = std::chrono::steady_clock::now();
+	std::vector<int16_t> evaluated = EvaluateNormalAnimation(frameData, jointIndices, staticIndexMax, frameCount);
+	auto evaluateEnd = std::chrono::steady_clock::now();
+
+	decodedValues += decoded.size();
+	decodeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(evaluateStart - decodeStart).count();
+	evaluateNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(evaluateEnd - evaluateStart).count();
+
+	if (decoded != evaluated)
+	{
+		printf("Animation %s did not survive compression, writing it uncompressed\n", normalAnim->GetName().c_str());
+		return false;
+	}
+
+	size_t legacySize = frameData.size() * sizeof(int16_t) + jointIndices.size() * sizeof(uint16_t);
+	size_t compressedSize = compressed.trackIndices.size() * sizeof(uint16_t) +
+	                        compressed.constValues.size() * sizeof(int16_t) +
+	                        compressed.baseValues.size() * sizeof(int16_t) + compressed.narrowDeltas.size() +
+	                        compressed.wideValues.size() * sizeof(int16_t);
+
+	return compressedSize < legacySize;
+}
+
+void OTRExporter_Animation::PrintDecodeStats()
+{
+	if (decodedValues == 0)
+		return;
+
+	// Values per microsecond equals millions of values per second
+	printf("Decoded %llu compressed animation values at %.1f M/s (uncompressed tables: %.1f M/s)\n",
+	       (unsigned long long)decodedValues.load(), decodedValues * 1000.0 / std::max<uint64_t>(decodeNanoseconds, 1),
+	       decodedValues * 1000.0 / std::max<uint64_t>(evaluateNanoseconds, 1));
+}
 
 void OTRExporter_Animation::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZAnimation* anim = (ZAnimation*)res;
 
-	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Animation));
-
 	ZNormalAnimation* normalAnim = dynamic_cast<ZNormalAnimation*>(anim);
 	ZCurveAnimation* curveAnim = dynamic_cast<ZCurveAnimation*>(anim);
 	ZLinkAnimation* linkAnim = dynamic_cast<ZLinkAnimation*>(anim);
+
+	CompressedNormalAnimation compressed;
+	bool compress = compressAnims && linkAnim == nullptr && curveAnim == nullptr && normalAnim != nullptr &&
+	                CompressAnimation(normalAnim, compressed);
+
+	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Animation), compress ? ANIMATION_COMPRESSED_VERSION : 0);
+
 	if (linkAnim != nullptr)
 	{
 		writer->Write((uint32_t)SOH::AnimationType::Link);
@@ -30,11 +100,11 @@ void OTRExporter_Animation::Save(ZResource* res, const fs::path& outPath, Binary
 			if (name.at(0) == '&')
 				name.erase(0, 1);
 
-			writer->Write(StringHelper::Sprintf("__OTR__misc/link_animetion/%s", name.c_str()));
+			WritePath(res, writer, StringHelper::Sprintf("__OTR__misc/link_animetion/%s", name.c_str()));
 		}
 		else
 		{
-			writer->Write("");
+			WritePath(res, writer, "");
 		}
 		//writer->Write((uint32_t)linkAnim->segmentAddress);
 	}
@@ -64,6 +134,23 @@ void OTRExporter_Animation::Save(ZResource* res, const fs::path& outPath, Binary
 		for (auto val : curveAnim->copyValuesArr)
 			writer->Write(val);
 	}
+	else if (compress)
+	{
+		writer->Write((uint32_t)SOH::AnimationType::Normal);
+		writer->Write(compressed.frameCount);
+
+		writer->Write((uint32_t)compressed.trackIndices.size());
+		WriteArray(writer, compressed.trackIndices);
+
+		writer->Write((uint32_t)compressed.constValues.size());
+		WriteArray(writer, compressed.constValues);
+
+		writer->Write(compressed.narrowCount);
+		writer->Write(compressed.wideCount);
+		WriteArray(writer, compressed.baseValues);
+		WriteArray(writer, compressed.narrowDeltas);
+		WriteArray(writer, compressed.wideValues);
+	}
 	else if (normalAnim != nullptr)
 	{
 		writer->Write((uint32_t)SOH::AnimationType::Normal);
@@ -1,116 +1,100 @@
 #include "ArrayExporter.h"
 #include "VtxExporter.h"
+#include "Main.h"
 #include <ZVector.h>
+// Size of the scalar types the array writer knows about. Other types are skipped, as before.
+static size_t GetScalarWriteSize(ZScalarType scalarType)
+{
+	switch (scalarType)
+	{
+	case ZScalarType::ZSCALAR_S8:
+	case ZScalarType::ZSCALAR_U8:
+	case ZScalarType::ZSCALAR_X8:
+		return 1;
+	case ZScalarType::ZSCALAR_S16:
+	case ZScalarType::ZSCALAR_U16:
+	case ZScalarType::ZSCALAR_X16:
+		return 2;
+	case ZScalarType::ZSCALAR_S32:
+	case ZScalarType::ZSCALAR_U32:
+	case ZScalarType::ZSCALAR_X32:
+		return 4;
+	case ZScalarType::ZSCALAR_S64:
+	case ZScalarType::ZSCALAR_U64:
+	case ZScalarType::ZSCALAR_X64:
+		return 8;
+		// OTRTODO: ADD OTHER TYPES
+	default:
+		return 0;
+	}
+}
+
+template <typename T>
+static void AppendRaw(std::vector<char>& buffer, const T& value, size_t size = sizeof(T))
+{
+	const char* bytes = (const char*)&value;
+	buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
 void OTRExporter_Array::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZArray* arr = (ZArray*)res;
+	ZResourceType elementType = arr->resList[0]->GetResourceType();
+
+	if (elementType == ZResourceType::Vertex && vtxRuntimeLayout)
+	{
+		std::vector<OTRVtx> vertices;
+		vertices.reserve(arr->arrayCnt);
+
+		for (size_t i = 0; i < arr->arrayCnt; i++)
+			vertices.push_back(OTRExporter_Vtx::PackVtx((ZVtx*)arr->resList[i]));
+
+		WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Array), VTX_RUNTIME_LAYOUT_VERSION);
+		writer->Write((uint32_t)elementType);
+		OTRExporter_Vtx::WriteRuntimeVtxList(writer, vertices);
+		return;
+	}
 
 	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Array));
 
-	writer->Write((uint32_t)arr->resList[0]->GetResourceType());
+	writer->Write((uint32_t)elementType);
 	writer->Write((uint32_t)arr->arrayCnt);
 
-	for (size_t i = 0; i < arr->arrayCnt; i++)
+	if (elementType == ZResourceType::Vertex)
 	{
-		if (arr->resList[i]->GetResourceType() == ZResourceType::Vertex)
-		{
-			ZVtx* vtx = (ZVtx*)arr->resList[i];
-			writer->Write(vtx->x);
-			writer->Write(vtx->y);
-			writer->Write(vtx->z);
-			writer->Write(vtx->flag);
-			writer->Write(vtx->s);
-			writer->Write(vtx->t);
-			writer->Write(vtx->r);
-			writer->Write(vtx->g);
-			writer->Write(vtx->b);
-			writer->Write(vtx->a);
-		}
-		else if (arr->resList[i]->GetResourceType() == ZResourceType::Vector)
+		OTRExporter_Vtx::WriteVtxList(writer, arr->resList, arr->arrayCnt);
+		return;
+	}
+
+	// Vectors and scalars carry a small per-element header, so they are packed into one buffer first.
+	// Every member of the scalar union starts at offset 0, so copying the first N bytes yields the value
+	// in native byte order, same as writing the member directly.
+	std::vector<char> buffer;
+
+	if (elementType == ZResourceType::Vector)
+	{
+		for (size_t i = 0; i < arr->arrayCnt; i++)
 		{
 			ZVector* vec = (ZVector*)arr->resList[i];
-			writer->Write((uint32_t)vec->scalarType);
-			writer->Write((uint32_t)vec->dimensions);
+			size_t scalarSize = GetScalarWriteSize(vec->scalarType);
+
+			AppendRaw(buffer, (uint32_t)vec->scalarType);
+			AppendRaw(buffer, (uint32_t)vec->dimensions);
 
-			for (size_t k = 0; k < vec->dimensions; k++)
-			{
-				// OTRTODO: Duplicate code here. Cleanup at a later date...
-				switch (vec->scalarType)
-				{
-				case ZScalarType::ZSCALAR_S8:
-					writer->Write(vec->scalars[k].scalarData.s8);
-					break;
-				case ZScalarType::ZSCALAR_U8:
-				case ZScalarType::ZSCALAR_X8:
-					writer->Write(vec->scalars[k].scalarData.u8);
-					break;
-				case ZScalarType::ZSCALAR_S16:
-					writer->Write(vec->scalars[k].scalarData.s16);
-					break;
-				case ZScalarType::ZSCALAR_U16:
-				case ZScalarType::ZSCALAR_X16:
-					writer->Write(vec->scalars[k].scalarData.u16);
-					break;
-				case ZScalarType::ZSCALAR_S32:
-					writer->Write(vec->scalars[k].scalarData.s32);
-					break;
-				case ZScalarType::ZSCALAR_U32:
-				case ZScalarType::ZSCALAR_X32:
-					writer->Write(vec->scalars[k].scalarData.u32);
-					break;
-				case ZScalarType::ZSCALAR_S64:
-					writer->Write(vec->scalars[k].scalarData.s64);
-					break;
-				case ZScalarType::ZSCALAR_U64:
-				case ZScalarType::ZSCALAR_X64:
-					writer->Write(vec->scalars[k].scalarData.u64);
-					break;
-					// OTRTODO: ADD OTHER TYPES
-				default:
-					break;
-				}
-			}
+			for (size_t k = 0; k < vec->dimensions && scalarSize != 0; k++)
+				AppendRaw(buffer, vec->scalars[k].scalarData, scalarSize);
 		}
-		else
+	}
+	else
+	{
+		for (size_t i = 0; i < arr->arrayCnt; i++)
 		{
 			ZScalar* scal = (ZScalar*)arr->resList[i];
 
-			writer->Write((uint32_t)scal->scalarType);
-
-			switch (scal->scalarType)
-			{
-			case ZScalarType::ZSCALAR_S8:
-				writer->Write(scal->scalarData.s8);
-				break;
-			case ZScalarType::ZSCALAR_U8:
-			case ZScalarType::ZSCALAR_X8:
-				writer->Write(scal->scalarData.u8);
-				break;
-			case ZScalarType::ZSCALAR_S16:
-				writer->Write(scal->scalarData.s16);
-				break;
-			case ZScalarType::ZSCALAR_U16:
-			case ZScalarType::ZSCALAR_X16:
-				writer->Write(scal->scalarData.u16);
-				break;
-			case ZScalarType::ZSCALAR_S32:
-				writer->Write(scal->scalarData.s32);
-				break;
-			case ZScalarType::ZSCALAR_U32:
-			case ZScalarType::ZSCALAR_X32:
-				writer->Write(scal->scalarData.u32);
-				break;
-			case ZScalarType::ZSCALAR_S64:
-				writer->Write(scal->scalarData.s64);
-				break;
-			case ZScalarType::ZSCALAR_U64:
-			case ZScalarType::ZSCALAR_X64:
-				writer->Write(scal->scalarData.u64);
-				break;
-				// OTRTODO: ADD OTHER TYPES
-			default:
-				break;
-			}
+			AppendRaw(buffer, (uint32_t)scal->scalarType);
+			AppendRaw(buffer, scal->scalarData, GetScalarWriteSize(scal->scalarType));
 		}
 	}
+
+	WriteArray(writer, buffer);
 }
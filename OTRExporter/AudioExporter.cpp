@@ -4,6 +4,7 @@
 #include <Globals.h>
 #include <Utils/DiskFile.h>
 #include "DisplayListExporter.h"
+#include "Dependencies.h"
 
 const char* OTRExporter_Audio::GetMediumStr(uint8_t medium) {
     switch (medium) {
@@ -93,15 +94,13 @@ void OTRExporter_Audio::WriteSampleEntry(SampleEntry* entry, BinaryWriter* write
     writer->Write((uint32_t)(entry->loop.count));
     writer->Write((uint32_t)entry->loop.states.size());
 
-    for (size_t i = 0; i < entry->loop.states.size(); i++)
-        writer->Write((entry->loop.states[i]));
+    WriteArray(writer, entry->loop.states);
 
     writer->Write((uint32_t)(entry->book.order));
     writer->Write((uint32_t)(entry->book.npredictors));
     writer->Write((uint32_t)entry->book.books.size());
 
-    for (size_t i = 0; i < entry->book.books.size(); i++)
-        writer->Write((entry->book.books[i]));
+    WriteArray(writer, entry->book.books);
 }
 
 void OTRExporter_Audio::WriteSampleEntry(SampleEntry* entry, tinyxml2::XMLElement* xmlDoc) {
@@ -145,7 +144,7 @@ void OTRExporter_Audio::WriteSoundFontEntry(ZAudio* audio, SoundFontEntry* entry
     {
         // This second byte isn't used but is needed to maintain compatibility with the V2 format.
         writer->Write((uint8_t)(entry != nullptr ? 1 : 0));
-        writer->Write(GetSampleEntryReference(audio, entry->sampleEntry));
+        WritePath(nullptr, writer, GetSampleEntryReference(audio, entry->sampleEntry));
         writer->Write(entry->tuning);
     }
 }
@@ -162,18 +161,24 @@ void OTRExporter_Audio::WriteSoundFontEntry(ZAudio* audio, SoundFontEntry* entry
     xmlDoc->InsertEndChild(sfEntry);
 }
 
-void OTRExporter_Audio::WriteEnvData(std::vector<AdsrEnvelope*> envelopes, BinaryWriter* writer)
+void OTRExporter_Audio::WriteEnvData(const std::vector<AdsrEnvelope*>& envelopes, BinaryWriter* writer)
 {
     writer->Write((uint32_t)envelopes.size());
 
-    for (auto env : envelopes)
+    // Envelopes are stored as pointers, so gather the delay/arg pairs before writing them in one go.
+    std::vector<int16_t> envData;
+    envData.reserve(envelopes.size() * 2);
+
+    for (const auto env : envelopes)
     {
-        writer->Write(env->delay);
-        writer->Write(env->arg);
+        envData.push_back(env->delay);
+        envData.push_back(env->arg);
     }
+
+    WriteArray(writer, envData);
 }
 
-void OTRExporter_Audio::WriteEnvData(std::vector<AdsrEnvelope*> envelopes, tinyxml2::XMLElement* xmlDoc) {
+void OTRExporter_Audio::WriteEnvData(const std::vector<AdsrEnvelope*>& envelopes, tinyxml2::XMLElement* xmlDoc) {
     tinyxml2::XMLElement* envs = xmlDoc->InsertNewChildElement("Envelopes");
     envs->SetAttribute("Count", (uint32_t)envelopes.size());
 
@@ -281,7 +286,7 @@ void OTRExporter_Audio::WriteSoundFontTableBinary(ZAudio* audio) {
             WriteEnvData(audio->soundFontTable[i].drums[k].env, &fntWriter);
             fntWriter.Write((uint8_t)(audio->soundFontTable[i].drums[k].sample != nullptr ? 1 : 0));
 
-            fntWriter.Write(GetSampleEntryReference(audio, audio->soundFontTable[i].drums[k].sample));
+            WritePath(nullptr, &fntWriter, GetSampleEntryReference(audio, audio->soundFontTable[i].drums[k].sample));
             fntWriter.Write(audio->soundFontTable[i].drums[k].tuning);
         }
 
@@ -307,6 +312,21 @@ void OTRExporter_Audio::WriteSoundFontTableBinary(ZAudio* audio) {
         std::string fName = OTRExporter_DisplayList::GetPathToRes(
             (ZResource*)(audio), StringHelper::Sprintf("fonts/%s", audio->soundFontNames[i].c_str()));
         AddFile(fName, fntStream->ToVector());
+
+        for (const auto& drum : audio->soundFontTable[i].drums)
+            AddDependency(fName, GetSampleEntryReference(audio, drum.sample));
+
+        for (const auto& instrument : audio->soundFontTable[i].instruments) {
+            for (SoundFontEntry* entry : { instrument.lowNotesSound, instrument.normalNotesSound, instrument.highNotesSound }) {
+                if (entry != nullptr)
+                    AddDependency(fName, GetSampleEntryReference(audio, entry->sampleEntry));
+            }
+        }
+
+        for (SoundFontEntry* entry : audio->soundFontTable[i].soundEffects) {
+            if (entry != nullptr)
+                AddDependency(fName, GetSampleEntryReference(audio, entry->sampleEntry));
+        }
     }
 }
 
@@ -358,7 +378,15 @@ void OTRExporter_Audio::WriteSequenceBinary(ZAudio* audio) {
         MemoryStream* seqStream = new MemoryStream();
         BinaryWriter seqWriter = BinaryWriter(seqStream);
 
-        WriteHeader(nullptr, "", &seqWriter, static_cast<uint32_t>(SOH::ResourceType::SOH_AudioSequence), 2);
+        // Version 3 appends a seek index after the version 2 fields.
+        SeqIndex seqIndex;
+        bool hasIndex = seqIndexInterval != 0 && BuildSequenceIndex(seq, seqIndexInterval, seqIndex);
+
+        if (seqIndexInterval != 0 && !hasIndex)
+            printf("Sequence %s could not be indexed, writing it without a seek index\n", audio->seqNames[i].c_str());
+
+        WriteHeader(nullptr, "", &seqWriter, static_cast<uint32_t>(SOH::ResourceType::SOH_AudioSequence),
+                    hasIndex ? 3 : 2);
 
         seqWriter.Write((uint32_t)seq.size());
         seqWriter.Write(seq.data(), seq.size());
@@ -370,12 +398,91 @@ void OTRExporter_Audio::WriteSequenceBinary(ZAudio* audio) {
         for (size_t k = 0; k < audio->fontIndices[i].size(); k++)
             seqWriter.Write((uint8_t)audio->fontIndices[i][k]);
 
+        if (hasIndex)
+            WriteSequenceIndex(seqIndex, &seqWriter);
+
         std::string fName = OTRExporter_DisplayList::GetPathToRes(
             (ZResource*)(audio), StringHelper::Sprintf("sequences/%s", audio->seqNames[i].c_str()));
         AddFile(fName, seqStream->ToVector());
     }
 }
 
+static void WriteSeqScriptCheckpoint(const SeqScriptCheckpoint& script, BinaryWriter* writer) {
+    writer->Write(script.pc);
+
+    for (size_t i = 0; i < 4; i++)
+        writer->Write(script.stack[i]);
+
+    for (size_t i = 0; i < 4; i++)
+        writer->Write(script.remLoopIters[i]);
+
+    writer->Write(script.depth);
+    writer->Write(script.value);
+}
+
+void OTRExporter_Audio::WriteSequenceIndex(const SeqIndex& index, BinaryWriter* writer) {
+    writer->Write(index.interval);
+    writer->Write(index.loopStartTick);
+    writer->Write(index.loopEndTick);
+    writer->Write((uint32_t)index.checkpoints.size());
+
+    // Checkpoints vary in size, so they are serialized first and located through an offset table
+    // relative to the end of that table.
+    MemoryStream* cpStream = new MemoryStream();
+    BinaryWriter cpWriter = BinaryWriter(cpStream);
+    std::vector<uint32_t> offsets;
+
+    for (const auto& cp : index.checkpoints) {
+        offsets.push_back((uint32_t)cpWriter.GetBaseAddress());
+
+        cpWriter.Write(cp.tick);
+        WriteSeqScriptCheckpoint(cp.script, &cpWriter);
+        cpWriter.Write(cp.delay);
+        cpWriter.Write(cp.tempo);
+        cpWriter.Write(cp.transposition);
+
+        for (size_t i = 0; i < 8; i++)
+            cpWriter.Write(cp.soundScriptIO[i]);
+
+        cpWriter.Write((uint8_t)cp.channels.size());
+
+        for (const auto& ch : cp.channels) {
+            cpWriter.Write(ch.index);
+            cpWriter.Write((uint8_t)ch.stopScript);
+            cpWriter.Write((uint8_t)ch.largeNotes);
+            WriteSeqScriptCheckpoint(ch.script, &cpWriter);
+            cpWriter.Write(ch.delay);
+            cpWriter.Write(ch.dynTable);
+            cpWriter.Write(ch.fontId);
+            cpWriter.Write(ch.instrument);
+            cpWriter.Write(ch.volume);
+            cpWriter.Write(ch.pan);
+            cpWriter.Write(ch.transposition);
+
+            for (size_t i = 0; i < 8; i++)
+                cpWriter.Write(ch.soundScriptIO[i]);
+
+            cpWriter.Write((uint8_t)ch.layers.size());
+
+            for (const auto& layer : ch.layers) {
+                cpWriter.Write(layer.index);
+                WriteSeqScriptCheckpoint(layer.script, &cpWriter);
+                cpWriter.Write(layer.delay);
+                cpWriter.Write(layer.lastDelay);
+                cpWriter.Write(layer.shortNoteDefaultPlayPercentage);
+                cpWriter.Write(layer.instrument);
+                cpWriter.Write(layer.transposition);
+            }
+        }
+    }
+
+    for (uint32_t offset : offsets)
+        writer->Write(offset);
+
+    auto cpData = cpStream->ToVector();
+    writer->Write(cpData.data(), cpData.size());
+}
+
 std::string OTRExporter_Audio::GetSampleEntryStr(ZAudio* audio, SampleEntry* entry) {
     std::string basePath = "";
 
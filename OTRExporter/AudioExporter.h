@@ -3,6 +3,7 @@
 #include "ZResource.h"
 #include "ZAudio.h"
 #include "Exporter.h"
+#include "SequenceIndex.h"
 #include <Utils/BinaryWriter.h>
 #include <tinyxml2.h>
 
@@ -18,13 +19,14 @@ private:
     void WriteSoundFontTableXML(ZAudio* audio);
     void WriteSequenceBinary(ZAudio* audio);
     void WriteSequenceXML(ZAudio* audio);
+    void WriteSequenceIndex(const SeqIndex& index, BinaryWriter* writer);
     void WriteSampleBinary(ZAudio* audio);
     void WriteSampleXML(ZAudio* audio);
     std::string GetSampleEntryReference(ZAudio* audio, SampleEntry* entry);
     std::string GetSampleEntryStr(ZAudio* audio, SampleEntry* entry);
     std::string GetSampleDataStr(ZAudio* audio, SampleEntry* entry);
-    void WriteEnvData(std::vector<AdsrEnvelope*> envelopes, BinaryWriter* writer);
-    void WriteEnvData(std::vector<AdsrEnvelope*> envelopes, tinyxml2::XMLElement* xmlDoc);
+    void WriteEnvData(const std::vector<AdsrEnvelope*>& envelopes, BinaryWriter* writer);
+    void WriteEnvData(const std::vector<AdsrEnvelope*>& envelopes, tinyxml2::XMLElement* xmlDoc);
     void WriteSoundFontEntry(ZAudio* audio, SoundFontEntry* entry, BinaryWriter* writer);
     void WriteSoundFontEntry(ZAudio* audio, SoundFontEntry* entry, tinyxml2::XMLElement* xmlDoc, const char* name);
     const char* GetMediumStr(uint8_t medium);
@@ -0,0 +1,359 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static uint16_t PackRGB565(const float* color)
+{
+    auto quantize = [](float value, int max) {
+        return (uint16_t)std::clamp((int)std::lround(value * max / 255.0f), 0, max);
+    };
+
+    return (uint16_t)((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+}
+
+static void UnpackRGB565(uint16_t packed, uint8_t* color)
+{
+    uint8_t r = (packed >> 11) & 0x1F;
+    uint8_t g = (packed >> 5) & 0x3F;
+    uint8_t b = packed & 0x1F;
+
+    color[0] = (uint8_t)((r << 3) | (r >> 2));
+    color[1] = (uint8_t)((g << 2) | (g >> 4));
+    color[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+// Builds the four palette entries of a color block. With `threeColor` the last entry is transparent black.
+static void GetColorPalette(uint16_t color0, uint16_t color1, bool threeColor, uint8_t palette[4][4])
+{
+    UnpackRGB565(color0, palette[0]);
+    UnpackRGB565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = 0xFF;
+
+    for (int c = 0; c < 3; c++) {
+        if (threeColor) {
+            palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        } else {
+            palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+    }
+
+    palette[2][3] = 0xFF;
+    palette[3][3] = threeColor ? 0 : 0xFF;
+}
+
+static void GetAlphaPalette(uint8_t alpha0, uint8_t alpha1, uint8_t palette[8])
+{
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+
+    if (alpha0 > alpha1) {
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = (uint8_t)(((7 - i) * alpha0 + i * alpha1) / 7);
+    } else {
+        for (int i = 1; i < 5; i++)
+            palette[i + 1] = (uint8_t)(((5 - i) * alpha0 + i * alpha1) / 5);
+
+        palette[6] = 0;
+        palette[7] = 0xFF;
+    }
+}
+
+// Reads the 4x4 block at (bx, by), clamping reads past the image edges
+static void GetBlock(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by,
+                     uint8_t block[16][4])
+{
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t px = std::min(bx * 4 + x, width - 1);
+            uint32_t py = std::min(by * 4 + y, height - 1);
+
+            std::copy_n(&rgba[((size_t)py * width + px) * 4], 4, block[y * 4 + x]);
+        }
+    }
+}
+
+// Fits the two endpoints of a color block along the principal axis of the pixels that are used
+static void EncodeColorBlock(const uint8_t block[16][4], bool punchThrough, uint8_t* out)
+{
+    bool used[16];
+    float mean[3] = {};
+    int usedCount = 0;
+
+    for (int i = 0; i < 16; i++) {
+        used[i] = !punchThrough || block[i][3] >= 128;
+
+        if (!used[i])
+            continue;
+
+        for (int c = 0; c < 3; c++)
+            mean[c] += block[i][c];
+
+        usedCount++;
+    }
+
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+
+    if (usedCount != 0) {
+        for (int c = 0; c < 3; c++)
+            mean[c] /= usedCount;
+
+        float cov[6] = {};
+
+        for (int i = 0; i < 16; i++) {
+            if (!used[i])
+                continue;
+
+            float d[3] = { block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2] };
+
+            cov[0] += d[0] * d[0];
+            cov[1] += d[0] * d[1];
+            cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1];
+            cov[4] += d[1] * d[2];
+            cov[5] += d[2] * d[2];
+        }
+
+        // A few power iterations are enough to find the dominant axis
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+
+        for (int iter = 0; iter < 8; iter++) {
+            float next[3] = {
+                cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+            };
+            float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+
+            if (length < 1e-6f)
+                break;
+
+            for (int c = 0; c < 3; c++)
+                axis[c] = next[c] / length;
+        }
+
+        float minProj = std::numeric_limits<float>::max();
+        float maxProj = std::numeric_limits<float>::lowest();
+
+        for (int i = 0; i < 16; i++) {
+            if (!used[i])
+                continue;
+
+            float proj = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] +
+                         (block[i][2] - mean[2]) * axis[2];
+
+            minProj = std::min(minProj, proj);
+            maxProj = std::max(maxProj, proj);
+        }
+
+        float minColor[3];
+        float maxColor[3];
+
+        for (int c = 0; c < 3; c++) {
+            minColor[c] = std::clamp(mean[c] + axis[c] * minProj, 0.0f, 255.0f);
+            maxColor[c] = std::clamp(mean[c] + axis[c] * maxProj, 0.0f, 255.0f);
+        }
+
+        color0 = PackRGB565(maxColor);
+        color1 = PackRGB565(minColor);
+    }
+
+    // Four color mode needs color0 > color1, the three color mode with transparency color0 <= color1
+    if (punchThrough ? color0 > color1 : color0 < color1)
+        std::swap(color0, color1);
+
+    bool threeColor = color0 <= color1;
+    uint8_t palette[4][4];
+
+    GetColorPalette(color0, color1, threeColor, palette);
+
+    uint32_t indices = 0;
+
+    for (int i = 0; i < 16; i++) {
+        uint32_t index = 3;
+
+        if (used[i]) {
+            int bestError = std::numeric_limits<int>::max();
+            int choices = threeColor ? 3 : 4;
+
+            for (int p = 0; p < choices; p++) {
+                int error = 0;
+
+                for (int c = 0; c < 3; c++)
+                    error += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+
+                if (error < bestError) {
+                    bestError = error;
+                    index = p;
+                }
+            }
+        }
+
+        indices |= index << (i * 2);
+    }
+
+    out[0] = color0 & 0xFF;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF;
+    out[3] = color1 >> 8;
+
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+static void EncodeAlphaBlock(const uint8_t block[16][4], uint8_t* out)
+{
+    uint8_t alpha0 = 0;
+    uint8_t alpha1 = 0xFF;
+
+    for (int i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, block[i][3]);
+        alpha1 = std::min(alpha1, block[i][3]);
+    }
+
+    uint8_t palette[8];
+    GetAlphaPalette(alpha0, alpha1, palette);
+
+    uint64_t indices = 0;
+
+    for (int i = 0; i < 16; i++) {
+        uint64_t index = 0;
+        int bestError = std::numeric_limits<int>::max();
+
+        for (int p = 0; p < 8; p++) {
+            int error = std::abs(block[i][3] - palette[p]);
+
+            if (error < bestError) {
+                bestError = error;
+                index = p;
+            }
+        }
+
+        indices |= index << (i * 3);
+    }
+
+    out[0] = alpha0;
+    out[1] = alpha1;
+
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+BlockFormat ChooseBlockFormat(const std::vector<uint8_t>& rgba)
+{
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+        if (rgba[i] != 0 && rgba[i] != 0xFF)
+            return BlockFormat::BC3;
+    }
+
+    return BlockFormat::BC1;
+}
+
+std::vector<uint8_t> EncodeBlocks(BlockFormat format, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
+{
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockSize = format == BlockFormat::BC1 ? 8 : 16;
+
+    std::vector<uint8_t> blocks(blocksX * blocksY * blockSize);
+
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            uint8_t block[16][4];
+            uint8_t* out = &blocks[(by * blocksX + bx) * blockSize];
+
+            GetBlock(rgba, width, height, bx, by, block);
+
+            if (format == BlockFormat::BC1) {
+                bool punchThrough = false;
+
+                for (int i = 0; i < 16; i++)
+                    punchThrough |= block[i][3] < 128;
+
+                EncodeColorBlock(block, punchThrough, out);
+            } else {
+                EncodeAlphaBlock(block, out);
+                EncodeColorBlock(block, false, out + 8);
+            }
+        }
+    }
+
+    return blocks;
+}
+
+std::vector<uint8_t> DecodeBlocks(BlockFormat format, const std::vector<uint8_t>& blocks, uint32_t width,
+                                  uint32_t height)
+{
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockSize = format == BlockFormat::BC1 ? 8 : 16;
+
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint8_t* in = &blocks[(by * blocksX + bx) * blockSize];
+            const uint8_t* colorBlock = format == BlockFormat::BC1 ? in : in + 8;
+
+            uint16_t color0 = (uint16_t)(colorBlock[0] | (colorBlock[1] << 8));
+            uint16_t color1 = (uint16_t)(colorBlock[2] | (colorBlock[3] << 8));
+            uint32_t colorIndices = colorBlock[4] | (colorBlock[5] << 8) | (colorBlock[6] << 16) |
+                                    ((uint32_t)colorBlock[7] << 24);
+
+            uint8_t palette[4][4];
+            GetColorPalette(color0, color1, format == BlockFormat::BC1 && color0 <= color1, palette);
+
+            uint8_t alphaPalette[8];
+            uint64_t alphaIndices = 0;
+
+            if (format == BlockFormat::BC3) {
+                GetAlphaPalette(in[0], in[1], alphaPalette);
+
+                for (int i = 0; i < 6; i++)
+                    alphaIndices |= (uint64_t)in[2 + i] << (i * 8);
+            }
+
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t px = bx * 4 + i % 4;
+                uint32_t py = by * 4 + i / 4;
+
+                if (px >= width || py >= height)
+                    continue;
+
+                uint8_t* pixel = &rgba[((size_t)py * width + px) * 4];
+
+                std::copy_n(palette[(colorIndices >> (i * 2)) & 3], 4, pixel);
+
+                if (format == BlockFormat::BC3)
+                    pixel[3] = alphaPalette[(alphaIndices >> (i * 3)) & 7];
+            }
+        }
+    }
+
+    return rgba;
+}
+
+double ComputePSNR(const std::vector<uint8_t>& original, const std::vector<uint8_t>& decoded)
+{
+    double error = 0.0;
+    size_t count = 0;
+
+    for (size_t i = 0; i + 3 < original.size() && i + 3 < decoded.size(); i += 4) {
+        int firstChannel = original[i + 3] == 0 ? 3 : 0;
+
+        for (int c = firstChannel; c < 4; c++) {
+            double diff = (double)original[i + c] - decoded[i + c];
+
+            error += diff * diff;
+            count++;
+        }
+    }
+
+    if (count == 0 || error == 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
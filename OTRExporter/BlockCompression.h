@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// CPU encoder for GPU block-compressed textures. Input and output pixels are 32 bit RGBA (R, G, B, A bytes).
+// Images are split into 4x4 blocks; partial blocks at the right and bottom edges repeat the last row or column.
+
+enum class BlockFormat : uint32_t {
+    BC1 = 1, // 8 bytes per block, opaque or 1 bit alpha
+    BC3 = 3, // 16 bytes per block, interpolated alpha
+};
+
+// Picks BC1 for opaque and 1 bit alpha images and BC3 for anything with partial transparency.
+BlockFormat ChooseBlockFormat(const std::vector<uint8_t>& rgba);
+
+std::vector<uint8_t> EncodeBlocks(BlockFormat format, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height);
+
+// Reference decoder, used to check encoded textures at export time.
+std::vector<uint8_t> DecodeBlocks(BlockFormat format, const std::vector<uint8_t>& blocks, uint32_t width,
+                                  uint32_t height);
+
+// Peak signal to noise ratio between two RGBA images in dB. The color of fully transparent pixels in `original`
+// is ignored, only their alpha is compared.
+double ComputePSNR(const std::vector<uint8_t>& original, const std::vector<uint8_t>& decoded);
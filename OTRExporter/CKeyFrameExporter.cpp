@@ -3,6 +3,8 @@
 #include "DisplayListExporter.h"
 #include "Globals.h"
 #include "spdlog/spdlog.h"
+#include "AnimationCompression.h"
+#include "Main.h"
 
 // The Win32 API defines this function for its own uses.
 #ifdef FindResource
@@ -46,7 +48,7 @@ void OTRExporter_CKeyFrameSkel::Save(ZResource* res, const fs::path& outPath, Bi
                 name = "";
             }
         } 
-        writer->Write(name);
+        WritePath(res, writer, name);
         writer->Write(limb->numChildren);
         writer->Write(limb->flags);
 
@@ -67,7 +69,17 @@ void OTRExporter_CKeyFrameSkel::Save(ZResource* res, const fs::path& outPath, Bi
 void OTRExporter_CKeyFrameAnim::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer) {
     ZKeyFrameAnim* anim = (ZKeyFrameAnim*)res;
 
-    WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::TSH_CKeyFrameAnim));
+    // Track offsets are the running sum of the keyframe counts. Animations whose counts do not cover the keyframe
+    // list exactly keep the legacy layout.
+    std::vector<uint32_t> trackOffsets = { 0 };
+
+    for (const auto kf : anim->kfNums)
+        trackOffsets.push_back(trackOffsets.back() + (uint32_t)kf);
+
+    bool writeSoA = (kfSoA || kfHermite) && trackOffsets.back() == anim->keyFrames.size();
+
+    WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::TSH_CKeyFrameAnim),
+                writeSoA ? KEYFRAME_ANIM_SOA_VERSION : 0);
 
     writer->Write((uint8_t)anim->skel->limbType);
     if (anim->skel->limbType == ZKeyframeSkelType::Normal) {
@@ -82,6 +94,44 @@ void OTRExporter_CKeyFrameAnim::Save(ZResource* res, const fs::path& outPath, Bi
         }
     }
 
+    if (writeSoA) {
+        std::vector<int16_t> frames;
+        std::vector<int16_t> values;
+        std::vector<int16_t> velocities;
+
+        for (const auto k : anim->keyFrames) {
+            frames.push_back(k.frame);
+            values.push_back(k.value);
+            velocities.push_back(k.velocity);
+        }
+
+        writer->Write((uint32_t)anim->kfNums.size());
+        WriteArray(writer, trackOffsets);
+
+        writer->Write((uint32_t)anim->keyFrames.size());
+        WriteArray(writer, frames);
+        WriteArray(writer, values);
+        WriteArray(writer, velocities);
+
+        writer->Write((uint32_t)anim->presetValues.size());
+        for (const auto pv : anim->presetValues) {
+            writer->Write(pv);
+        }
+
+        writer->Write(anim->unk_10);
+        writer->Write(anim->duration);
+
+        writer->Write((uint8_t)kfHermite);
+        if (kfHermite) {
+            // Pad so the coefficients can be loaded as aligned float vectors
+            while (writer->GetBaseAddress() % 16 != 0)
+                writer->Write((uint8_t)0);
+
+            WriteArray(writer, BuildKeyFrameHermiteCoefficients(frames, values, velocities, trackOffsets));
+        }
+        return;
+    }
+
     writer->Write((uint32_t)anim->keyFrames.size());
     for (const auto k : anim->keyFrames) {
         writer->Write(k.frame);
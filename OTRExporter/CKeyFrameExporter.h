@@ -6,6 +6,12 @@
 #include "Exporter.h"
 #include <Utils/BinaryWriter.h>
 
+// Version 1 of keyframe animations stores keyframes as separate frame, value and velocity arrays with an offset
+// table marking where each track starts, replacing the per-track keyframe counts. Hermite coefficients for every
+// keyframe can be appended (see AnimationCompression.h) after a u8 flag; they start at the next 16 byte boundary of
+// the resource.
+#define KEYFRAME_ANIM_SOA_VERSION 1
+
 class OTRExporter_CKeyFrameSkel : public OTRExporter 
 {
 public:
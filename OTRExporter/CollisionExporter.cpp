@@ -1,12 +1,390 @@
 #include "CollisionExporter.h"
+#include "Main.h"
 #include <libultraship/bridge.h>
+#include <algorithm>
+#include <cmath>
+
+// Matches the game's static lookup setup (BgCheck_Allocate / BgCheck_SetSubdivisionDimension)
+#define COL_LOOKUP_SUBDIV_X 16
+#define COL_LOOKUP_SUBDIV_Y 4
+#define COL_LOOKUP_SUBDIV_Z 16
+#define COL_LOOKUP_SUBDIV_MIN 150.0f
+#define COL_LOOKUP_SUBDIV_OVERLAP 50.0f
+
+#define COL_POLY_VTX_INDEX(id) ((id) & 0x1FFF)
+#define COL_NORMAL_TO_FLOAT(n) ((n) * (1.0f / 32767.0f))
+
+struct ColVtx
+{
+	int16_t x, y, z;
+};
+
+static float GetSubdivisionLength(float min, float max, int32_t amount)
+{
+	float length = (float)((int32_t)((max - min) / amount) + 1);
+
+	return std::max(length, COL_LOOKUP_SUBDIV_MIN);
+}
+
+static int32_t GetSubdivisionCell(float pos, float min, float length, int32_t amount)
+{
+	int32_t cell = (int32_t)std::floor((pos - min) / length);
+
+	return std::clamp(cell, 0, amount - 1);
+}
+
+// Separating axis test between a triangle and an axis aligned box. The game does the same rejection with its own
+// point/edge/face classification (BgCheck_PolyIntersectsSubdivision); both agree except for polygons that only
+// touch a cell within float rounding.
+static bool TriangleIntersectsBox(const float tri[3][3], const float boxMin[3], const float boxMax[3])
+{
+	float center[3];
+	float half[3];
+	float v[3][3];
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		center[axis] = (boxMin[axis] + boxMax[axis]) * 0.5f;
+		half[axis] = (boxMax[axis] - boxMin[axis]) * 0.5f;
+
+		for (int k = 0; k < 3; k++)
+			v[k][axis] = tri[k][axis] - center[axis];
+	}
+
+	auto separated = [&](const float* dir) {
+		float p[3];
+
+		for (int k = 0; k < 3; k++)
+			p[k] = v[k][0] * dir[0] + v[k][1] * dir[1] + v[k][2] * dir[2];
+
+		float r = half[0] * std::abs(dir[0]) + half[1] * std::abs(dir[1]) + half[2] * std::abs(dir[2]);
+
+		return std::min({ p[0], p[1], p[2] }) > r || std::max({ p[0], p[1], p[2] }) < -r;
+	};
+
+	float edges[3][3];
+
+	for (int k = 0; k < 3; k++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+			edges[k][axis] = v[(k + 1) % 3][axis] - v[k][axis];
+	}
+
+	// Box face normals
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float dir[3] = { axis == 0 ? 1.0f : 0.0f, axis == 1 ? 1.0f : 0.0f, axis == 2 ? 1.0f : 0.0f };
+
+		if (separated(dir))
+			return false;
+	}
+
+	// Triangle normal
+	const float normal[3] = { edges[0][1] * edges[1][2] - edges[0][2] * edges[1][1],
+							  edges[0][2] * edges[1][0] - edges[0][0] * edges[1][2],
+							  edges[0][0] * edges[1][1] - edges[0][1] * edges[1][0] };
+
+	if (separated(normal))
+		return false;
+
+	// Cross products of the box axes and the triangle edges
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			const float* e = edges[k];
+			const float dir[3] = { axis == 0 ? 0.0f : (axis == 1 ? e[2] : -e[1]),
+								   axis == 1 ? 0.0f : (axis == 0 ? -e[2] : e[0]),
+								   axis == 2 ? 0.0f : (axis == 0 ? e[1] : -e[0]) };
+
+			if (separated(dir))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Writes the static lookup grid the game otherwise builds at scene load. Every cell holds three polygon
+// lists (floors, walls, ceilings). Like StaticLookup_AddPolyToSSList, lists are ordered by the polygon's lowest
+// point, bottom first, with ties kept in polygon order. A polygon is added to each cell its bounds (grown by the
+// subdivision overlap) touch and that it actually intersects. Lists are stored as offsets into one shared index
+// array per list kind.
+template <typename PolyList>
+static void WriteStaticLookup(ZCollisionHeader* col, const std::vector<ColVtx>& vertices, const PolyList& polygons,
+							  BinaryWriter* writer)
+{
+	const int32_t amount[3] = { COL_LOOKUP_SUBDIV_X, COL_LOOKUP_SUBDIV_Y, COL_LOOKUP_SUBDIV_Z };
+	const float min[3] = { (float)col->absMinX, (float)col->absMinY, (float)col->absMinZ };
+	const float max[3] = { (float)col->absMaxX, (float)col->absMaxY, (float)col->absMaxZ };
+	float length[3];
+
+	for (int i = 0; i < 3; i++)
+		length[i] = GetSubdivisionLength(min[i], max[i], amount[i]);
+
+	const size_t cellCount = amount[0] * amount[1] * amount[2];
+	std::vector<std::vector<uint16_t>> lists[3];
+	std::vector<int16_t> polyMinY(polygons.size());
+
+	for (auto& list : lists)
+		list.resize(cellCount);
+
+	for (size_t i = 0; i < polygons.size(); i++)
+	{
+		const auto& poly = polygons[i];
+
+		if (COL_POLY_VTX_INDEX(poly.vtxA) >= vertices.size() || COL_POLY_VTX_INDEX(poly.vtxB) >= vertices.size() ||
+			COL_POLY_VTX_INDEX(poly.vtxC) >= vertices.size())
+			continue;
+
+		const ColVtx* v[3] = { &vertices[COL_POLY_VTX_INDEX(poly.vtxA)], &vertices[COL_POLY_VTX_INDEX(poly.vtxB)],
+							   &vertices[COL_POLY_VTX_INDEX(poly.vtxC)] };
+		int16_t polyMin[3] = { v[0]->x, v[0]->y, v[0]->z };
+		int16_t polyMax[3] = { v[0]->x, v[0]->y, v[0]->z };
+
+		for (int k = 1; k < 3; k++)
+		{
+			const int16_t pos[3] = { v[k]->x, v[k]->y, v[k]->z };
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				polyMin[axis] = std::min(polyMin[axis], pos[axis]);
+				polyMax[axis] = std::max(polyMax[axis], pos[axis]);
+			}
+		}
+
+		polyMinY[i] = polyMin[1];
+
+		// 0 = floor, 1 = wall, 2 = ceiling
+		float normY = COL_NORMAL_TO_FLOAT(poly.normY);
+		int kind = (normY > 0.5f) ? 0 : ((normY < -0.8f) ? 2 : 1);
+		int32_t cellMin[3];
+		int32_t cellMax[3];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			cellMin[axis] = GetSubdivisionCell(polyMin[axis] - COL_LOOKUP_SUBDIV_OVERLAP, min[axis], length[axis], amount[axis]);
+			cellMax[axis] = GetSubdivisionCell(polyMax[axis] + COL_LOOKUP_SUBDIV_OVERLAP, min[axis], length[axis], amount[axis]);
+		}
+
+		const float tri[3][3] = { { (float)v[0]->x, (float)v[0]->y, (float)v[0]->z },
+								  { (float)v[1]->x, (float)v[1]->y, (float)v[1]->z },
+								  { (float)v[2]->x, (float)v[2]->y, (float)v[2]->z } };
+
+		for (int32_t z = cellMin[2]; z <= cellMax[2]; z++)
+		{
+			for (int32_t y = cellMin[1]; y <= cellMax[1]; y++)
+			{
+				for (int32_t x = cellMin[0]; x <= cellMax[0]; x++)
+				{
+					const int32_t cell[3] = { x, y, z };
+					float cellBoxMin[3];
+					float cellBoxMax[3];
+
+					for (int axis = 0; axis < 3; axis++)
+					{
+						cellBoxMin[axis] = min[axis] + cell[axis] * length[axis] - COL_LOOKUP_SUBDIV_OVERLAP;
+						cellBoxMax[axis] = cellBoxMin[axis] + length[axis] + COL_LOOKUP_SUBDIV_OVERLAP * 2;
+					}
+
+					if (TriangleIntersectsBox(tri, cellBoxMin, cellBoxMax))
+						lists[kind][x + y * amount[0] + z * amount[0] * amount[1]].push_back((uint16_t)i);
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+		writer->Write((uint16_t)amount[i]);
+
+	writer->Write((uint16_t)0);
+
+	for (int i = 0; i < 3; i++)
+		writer->Write(min[i]);
+
+	for (int i = 0; i < 3; i++)
+		writer->Write(length[i]);
+
+	for (auto& kindLists : lists)
+	{
+		uint32_t offset = 0;
+
+		for (auto& list : kindLists)
+		{
+			std::stable_sort(list.begin(), list.end(),
+							 [&](uint16_t a, uint16_t b) { return polyMinY[a] < polyMinY[b]; });
+
+			writer->Write(offset);
+			offset += (uint32_t)list.size();
+		}
+
+		writer->Write(offset);
+
+		for (auto& list : kindLists)
+			writer->Write((char*)list.data(), list.size() * sizeof(uint16_t));
+	}
+}
+
+static uint32_t SpreadMortonBits(uint32_t v)
+{
+	v &= 0x3FF;
+	v = (v | (v << 16)) & 0x030000FF;
+	v = (v | (v << 8)) & 0x0300F00F;
+	v = (v | (v << 4)) & 0x030C30C3;
+	v = (v | (v << 2)) & 0x09249249;
+
+	return v;
+}
+
+// Sorts polygons along a Z-order curve of their centroids and renumbers vertices in the order the sorted
+// polygons first use them, so polygons that are close in space are also close in memory. The flag bits
+// stored above the vertex indices are kept. oldToNew tables are filled for polygons and vertices so anything
+// indexing them can be fixed up; the polygon types, camera data and water boxes do not index either list.
+template <typename PolyList>
+static bool ReorderForLocality(ZCollisionHeader* col, std::vector<ColVtx>& vertices, PolyList& polygons,
+							   std::vector<uint16_t>& polyOldToNew, std::vector<uint16_t>& vtxOldToNew)
+{
+	for (const auto& poly : polygons)
+	{
+		if (COL_POLY_VTX_INDEX(poly.vtxA) >= vertices.size() || COL_POLY_VTX_INDEX(poly.vtxB) >= vertices.size() ||
+			COL_POLY_VTX_INDEX(poly.vtxC) >= vertices.size())
+			return false;
+	}
+
+	const float min[3] = { (float)col->absMinX, (float)col->absMinY, (float)col->absMinZ };
+	const float max[3] = { (float)col->absMaxX, (float)col->absMaxY, (float)col->absMaxZ };
+	std::vector<std::pair<uint32_t, uint16_t>> keys;
+	keys.reserve(polygons.size());
+
+	for (size_t i = 0; i < polygons.size(); i++)
+	{
+		const auto& poly = polygons[i];
+		const ColVtx& a = vertices[COL_POLY_VTX_INDEX(poly.vtxA)];
+		const ColVtx& b = vertices[COL_POLY_VTX_INDEX(poly.vtxB)];
+		const ColVtx& c = vertices[COL_POLY_VTX_INDEX(poly.vtxC)];
+		const float centroid[3] = { (a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f };
+		uint32_t code = 0;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float range = std::max(max[axis] - min[axis], 1.0f);
+			uint32_t cell = (uint32_t)std::clamp((centroid[axis] - min[axis]) / range * 1023.0f, 0.0f, 1023.0f);
+
+			code |= SpreadMortonBits(cell) << axis;
+		}
+
+		keys.push_back({ code, (uint16_t)i });
+	}
+
+	std::stable_sort(keys.begin(), keys.end(),
+					 [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	const uint16_t unassigned = 0xFFFF;
+	PolyList sorted;
+	std::vector<ColVtx> renumbered;
+	sorted.reserve(polygons.size());
+	renumbered.reserve(vertices.size());
+	polyOldToNew.assign(polygons.size(), 0);
+	vtxOldToNew.assign(vertices.size(), unassigned);
+
+	auto remapVtx = [&](uint16_t id) {
+		uint16_t oldIdx = COL_POLY_VTX_INDEX(id);
+
+		if (vtxOldToNew[oldIdx] == unassigned)
+		{
+			vtxOldToNew[oldIdx] = (uint16_t)renumbered.size();
+			renumbered.push_back(vertices[oldIdx]);
+		}
+
+		return (uint16_t)((id & ~0x1FFF) | vtxOldToNew[oldIdx]);
+	};
+
+	for (const auto& key : keys)
+	{
+		auto poly = polygons[key.second];
+
+		poly.vtxA = remapVtx(poly.vtxA);
+		poly.vtxB = remapVtx(poly.vtxB);
+		poly.vtxC = remapVtx(poly.vtxC);
+
+		polyOldToNew[key.second] = (uint16_t)sorted.size();
+		sorted.push_back(poly);
+	}
+
+	// Vertices no polygon uses keep their relative order at the end
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		if (vtxOldToNew[i] == unassigned)
+		{
+			vtxOldToNew[i] = (uint16_t)renumbered.size();
+			renumbered.push_back(vertices[i]);
+		}
+	}
+
+	polygons = std::move(sorted);
+	vertices = std::move(renumbered);
+	return true;
+}
+
+// Writes polygon normals and plane distances as float arrays (x, y, z, dist), each starting on a 16 byte
+// boundary and zero padded to a multiple of four entries, so plane tests can run four polygons at a time.
+template <typename PolyList>
+static void WritePlanes(const PolyList& polygons, BinaryWriter* writer)
+{
+	const size_t paddedCount = (polygons.size() + 3) & ~(size_t)3;
+	std::vector<float> planes[4];
+
+	for (auto& plane : planes)
+		plane.resize(paddedCount, 0.0f);
+
+	for (size_t i = 0; i < polygons.size(); i++)
+	{
+		planes[0][i] = COL_NORMAL_TO_FLOAT(polygons[i].normX);
+		planes[1][i] = COL_NORMAL_TO_FLOAT(polygons[i].normY);
+		planes[2][i] = COL_NORMAL_TO_FLOAT(polygons[i].normZ);
+		planes[3][i] = (float)polygons[i].dist;
+	}
+
+	writer->Write((uint32_t)paddedCount);
+
+	while (writer->GetBaseAddress() % 16 != 0)
+		writer->Write((uint8_t)0);
+
+	for (auto& plane : planes)
+		writer->Write((char*)plane.data(), plane.size() * sizeof(float));
+}
 
 void OTRExporter_Collision::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZCollisionHeader* col = (ZCollisionHeader*)res;
 
-	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_CollisionHeader));
-	
+	std::vector<ColVtx> vertices;
+	vertices.reserve(col->vertices.size());
+
+	for (auto& vtx : col->vertices)
+	{
+		vertices.push_back({ vtx.scalars[0].scalarData.s16, vtx.scalars[1].scalarData.s16,
+							 vtx.scalars[2].scalarData.s16 });
+	}
+
+	auto polygons = col->polygons;
+	std::vector<uint16_t> polyOldToNew;
+	std::vector<uint16_t> vtxOldToNew;
+
+	// Version 1 appends a set of optional sections after the version 0 data.
+	uint32_t sections = 0;
+
+	if (colStaticLookup)
+		sections |= COL_SECTION_STATIC_LOOKUP;
+
+	if (colReorder && ReorderForLocality(col, vertices, polygons, polyOldToNew, vtxOldToNew))
+		sections |= COL_SECTION_REMAP;
+
+	if (colPlanes)
+		sections |= COL_SECTION_PLANES;
+
+	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_CollisionHeader), sections != 0 ? 1 : 0);
+
 	writer->Write(col->absMinX);
 	writer->Write(col->absMinY);
 	writer->Write(col->absMinZ);
@@ -15,27 +393,27 @@ void OTRExporter_Collision::Save(ZResource* res, const fs::path& outPath, Binary
 	writer->Write(col->absMaxY);
 	writer->Write(col->absMaxZ);
 
-	writer->Write((uint32_t)col->vertices.size());
-	
-	for (uint16_t i = 0; i < col->vertices.size(); i++)
+	writer->Write((uint32_t)vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
 	{
-		writer->Write(col->vertices[i].scalars[0].scalarData.s16);
-		writer->Write(col->vertices[i].scalars[1].scalarData.s16);
-		writer->Write(col->vertices[i].scalars[2].scalarData.s16);
+		writer->Write(vertices[i].x);
+		writer->Write(vertices[i].y);
+		writer->Write(vertices[i].z);
 	}
 
-	writer->Write((uint32_t)col->polygons.size());
+	writer->Write((uint32_t)polygons.size());
 
-	for (uint16_t i = 0; i < col->polygons.size(); i++)
+	for (size_t i = 0; i < polygons.size(); i++)
 	{
-		writer->Write(col->polygons[i].type);
-		writer->Write(col->polygons[i].vtxA);
-		writer->Write(col->polygons[i].vtxB);
-		writer->Write(col->polygons[i].vtxC);
-		writer->Write(col->polygons[i].normX);
-		writer->Write(col->polygons[i].normY);
-		writer->Write(col->polygons[i].normZ);
-		writer->Write(col->polygons[i].dist);
+		writer->Write(polygons[i].type);
+		writer->Write(polygons[i].vtxA);
+		writer->Write(polygons[i].vtxB);
+		writer->Write(polygons[i].vtxC);
+		writer->Write(polygons[i].normX);
+		writer->Write(polygons[i].normY);
+		writer->Write(polygons[i].normZ);
+		writer->Write(polygons[i].dist);
 	}
 
 	writer->Write((uint32_t)col->polygonTypes.size());
@@ -50,12 +428,12 @@ void OTRExporter_Collision::Save(ZResource* res, const fs::path& outPath, Binary
 	for (auto entry : col->camData->entries)
 	{
 		auto camPosDecl = col->parent->GetDeclarationRanged(Seg2Filespace(entry.cameraPosDataSeg, col->parent->baseAddress));
-		
+
 		int idx = 0;
 
 		if (camPosDecl != nullptr)
 			idx = ((entry.cameraPosDataSeg & 0x00FFFFFF) - camPosDecl->address) / 6;
-		
+
 		writer->Write(entry.cameraSType);
 		writer->Write(entry.numData);
 		writer->Write((uint32_t)idx);
@@ -81,4 +459,23 @@ void OTRExporter_Collision::Save(ZResource* res, const fs::path& outPath, Binary
 		writer->Write(waterBox.zLength);
 		writer->Write(waterBox.properties);
 	}
+
+	if (sections == 0)
+		return;
+
+	writer->Write(sections);
+
+	if (sections & COL_SECTION_STATIC_LOOKUP)
+		WriteStaticLookup(col, vertices, polygons, writer);
+
+	if (sections & COL_SECTION_REMAP)
+	{
+		writer->Write((uint32_t)polyOldToNew.size());
+		WriteArray(writer, polyOldToNew);
+		writer->Write((uint32_t)vtxOldToNew.size());
+		WriteArray(writer, vtxOldToNew);
+	}
+
+	if (sections & COL_SECTION_PLANES)
+		WritePlanes(polygons, writer);
 }
@@ -4,6 +4,11 @@
 #include "ZCollision.h"
 #include "Exporter.h"
 
+// Optional sections written after the version 0 data of a version 1 collision header
+#define COL_SECTION_STATIC_LOOKUP (1 << 0)
+#define COL_SECTION_REMAP (1 << 1)
+#define COL_SECTION_PLANES (1 << 2)
+
 class OTRExporter_Collision : public OTRExporter
 {
 public:
@@ -0,0 +1,69 @@
+#include "ContentDedup.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+struct DedupEntry {
+    std::string path;
+    std::vector<char> data;
+};
+
+static std::mutex dedupMutex;
+static std::map<const void*, std::unordered_multimap<size_t, DedupEntry>> dedupScopes;
+static std::map<std::string, std::string> dedupAliases;
+
+std::string DedupResource(const void* scope, const std::string& path, const std::vector<char>& data)
+{
+    std::unique_lock Lock(dedupMutex);
+
+    auto alias = dedupAliases.find(path);
+
+    if (alias != dedupAliases.end())
+        return alias->second;
+
+    size_t hash = std::hash<std::string_view>()(std::string_view(data.data(), data.size()));
+    auto& entries = dedupScopes[scope];
+    auto range = entries.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; it++) {
+        if (it->second.data != data)
+            continue;
+
+        if (it->second.path != path)
+            dedupAliases[path] = it->second.path;
+
+        return it->second.path;
+    }
+
+    entries.insert({ hash, { path, data } });
+    return path;
+}
+
+std::map<std::string, std::string> GetDedupAliases()
+{
+    std::unique_lock Lock(dedupMutex);
+
+    return dedupAliases;
+}
+
+std::vector<char> BuildDedupAliasManifest(const std::set<std::string>* keep)
+{
+    auto aliases = GetDedupAliases();
+
+    if (keep != nullptr)
+        std::erase_if(aliases, [&](const auto& alias) { return !keep->contains(alias.second); });
+
+    MemoryStream* manifestStream = new MemoryStream();
+    BinaryWriter manifestWriter = BinaryWriter(manifestStream);
+
+    manifestWriter.Write((uint32_t)aliases.size());
+
+    for (const auto& alias : aliases) {
+        manifestWriter.Write(alias.first);
+        manifestWriter.Write(alias.second);
+    }
+
+    return manifestStream->ToVector();
+}
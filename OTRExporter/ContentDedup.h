@@ -0,0 +1,21 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Content-hash dedup for resources that are frequently identical, such as cutscenes and alternate scene headers.
+//
+// DedupResource returns the path a payload should be referenced by: `path` itself the first time the payload is
+// seen within `scope`, otherwise the path of the earlier identical payload. In the latter case `path` becomes an
+// alias and its entry is dropped from the archive at the end of the export. Scopes keep the choice of canonical
+// path deterministic when files are exported on several threads.
+std::string DedupResource(const void* scope, const std::string& path, const std::vector<char>& data);
+
+// Alias path -> canonical path
+std::map<std::string, std::string> GetDedupAliases();
+
+// Serialized alias table (u32 count, then alias/canonical path string pairs) for tools resolving old paths. With
+// `keep`, only aliases whose canonical path is in it are listed.
+std::vector<char> BuildDedupAliasManifest(const std::set<std::string>* keep = nullptr);
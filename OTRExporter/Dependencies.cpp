@@ -0,0 +1,129 @@
+#include "Dependencies.h"
+#include "DisplayListExporter.h"
+#include "Main.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <ship/utils/StrHash64.h>
+#include <algorithm>
+#include <mutex>
+
+static std::mutex dependencyMutex;
+static std::map<std::string, std::set<std::string>> dependencies;
+
+void AddDependency(const std::string& from, const std::string& to)
+{
+    if (!trackDependencies || from == "" || to == "")
+        return;
+
+    // Some references carry the "__OTR__" marker the runtime uses to tell archive paths from pointers
+    std::string target = to.starts_with("__OTR__") ? to.substr(7) : to;
+
+    std::unique_lock Lock(dependencyMutex);
+    dependencies[from].insert(target);
+}
+
+void AddDependency(ZResource* res, const std::string& to)
+{
+    if (!trackDependencies || res == nullptr || to == "")
+        return;
+
+    AddDependency(OTRExporter_DisplayList::GetPathToRes(res, res->GetName()), to);
+}
+
+std::map<std::string, std::set<std::string>> GetDependencies()
+{
+    std::unique_lock Lock(dependencyMutex);
+
+    return dependencies;
+}
+
+std::set<std::string> GetReachable(const std::set<std::string>& roots)
+{
+    auto graph = GetDependencies();
+
+    std::set<std::string> reachable = roots;
+    std::vector<std::string> pending(roots.begin(), roots.end());
+
+    while (!pending.empty()) {
+        std::string path = pending.back();
+        pending.pop_back();
+
+        auto it = graph.find(path);
+
+        if (it == graph.end())
+            continue;
+
+        for (const auto& to : it->second) {
+            if (reachable.insert(to).second)
+                pending.push_back(to);
+        }
+    }
+
+    return reachable;
+}
+
+std::vector<char> BuildDependencyGraph(const std::set<std::string>* keep)
+{
+    auto graph = GetDependencies();
+
+    if (keep != nullptr) {
+        std::erase_if(graph, [&](const auto& item) { return !keep->contains(item.first); });
+
+        for (auto& item : graph)
+            std::erase_if(item.second, [&](const std::string& to) { return !keep->contains(to); });
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> nodes;
+    std::set<std::string> seen;
+
+    for (const auto& item : graph) {
+        if (seen.insert(item.first).second)
+            nodes.push_back({ CRC64(item.first.c_str()), item.first });
+
+        for (const auto& to : item.second) {
+            if (seen.insert(to).second)
+                nodes.push_back({ CRC64(to.c_str()), to });
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+
+    std::map<std::string, uint32_t> nodeIndices;
+
+    for (size_t i = 0; i < nodes.size(); i++)
+        nodeIndices[nodes[i].second] = (uint32_t)i;
+
+    std::vector<uint32_t> edgeStarts;
+    std::vector<uint32_t> edges;
+
+    for (const auto& node : nodes) {
+        edgeStarts.push_back((uint32_t)edges.size());
+
+        auto it = graph.find(node.second);
+
+        if (it == graph.end())
+            continue;
+
+        for (const auto& to : it->second)
+            edges.push_back(nodeIndices[to]);
+    }
+
+    edgeStarts.push_back((uint32_t)edges.size());
+
+    MemoryStream* graphStream = new MemoryStream();
+    BinaryWriter graphWriter = BinaryWriter(graphStream);
+
+    graphWriter.Write((uint32_t)nodes.size());
+    graphWriter.Write((uint32_t)edges.size());
+
+    for (const auto& node : nodes)
+        graphWriter.Write(node.first);
+
+    for (uint32_t start : edgeStarts)
+        graphWriter.Write(start);
+
+    for (uint32_t edge : edges)
+        graphWriter.Write(edge);
+
+    return graphStream->ToVector();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ZResource.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Records references between archive entries while exporting. Exporters call AddDependency wherever they write a
+// path or path hash of another resource. Recording is off unless an option needing the graph is enabled.
+void AddDependency(const std::string& from, const std::string& to);
+// Same as above, with the referencing entry being `res` itself.
+void AddDependency(ZResource* res, const std::string& to);
+
+// Entry path -> paths it references
+std::map<std::string, std::set<std::string>> GetDependencies();
+
+// Returns `roots` plus every path transitively referenced from them.
+std::set<std::string> GetReachable(const std::set<std::string>& roots);
+
+// Serialized graph (native endian):
+//   u32 node count, u32 edge count
+//   u64 CRC64 of each node's path, sorted
+//   u32 edge start per node plus one final end offset
+//   u32 target node index per edge
+// With `keep`, paths not in it are left out along with their edges.
+std::vector<char> BuildDependencyGraph(const std::set<std::string>* keep = nullptr);
@@ -12,6 +12,9 @@
 #include <regex>
 #include <string>
 #include "MtxExporter.h"
+#include "VtxExporter.h"
+#include "Dependencies.h"
+#include "PathHash.h"
 #include <Utils/DiskFile.h>
 #include "VersionInfo.h"
 #undef FindResource
@@ -238,7 +241,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 				{
 					std::string vName = StringHelper::Sprintf("%s/%s", (GetParentFolderName(res).c_str()), mtxDecl->declName.c_str());
 
-					uint64_t hash = CRC64(vName.c_str());
+					uint64_t hash = HashPath(vName);
+					AddDependency(dbgName, vName);
 
 					word0 = hash >> 32;
 					word1 = hash & 0xFFFFFFFF;
@@ -276,7 +280,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 						std::string assocFileName = assocFile->GetName();
 						std::string fName = GetPathToRes(assocFile->resources[0], resourceName.c_str());
 
-						uint64_t hash = CRC64(fName.c_str());
+						uint64_t hash = HashPath(fName);
+						AddDependency(dbgName, fName);
 
 						word0 = hash >> 32;
 						word1 = hash & 0xFFFFFFFF;
@@ -385,7 +390,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 			{
 				std::string vName = StringHelper::Sprintf("%s/%s", (GetParentFolderName(res).c_str()), dListDecl->declName.c_str());
 
-				uint64_t hash = CRC64(vName.c_str());
+				uint64_t hash = HashPath(vName);
+				AddDependency(dbgName, vName);
 
 				word0 = hash >> 32;
 				word1 = hash & 0xFFFFFFFF;
@@ -401,7 +407,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 					std::string assocFileName = assocFile->GetName();
 					std::string fName = GetPathToRes(assocFile->resources[0], resourceName.c_str());
 
-					uint64_t hash = CRC64(fName.c_str());
+					uint64_t hash = HashPath(fName);
+					AddDependency(dbgName, fName);
 
 					word0 = hash >> 32;
 					word1 = hash & 0xFFFFFFFF;
@@ -502,7 +509,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 				{
 					std::string vName = StringHelper::Sprintf("%s/%s", (GetParentFolderName(res).c_str()), dListDecl->declName.c_str());
 
-					uint64_t hash = CRC64(vName.c_str());
+					uint64_t hash = HashPath(vName);
+					AddDependency(dbgName, vName);
 
 					word0 = hash >> 32;
 					word1 = hash & 0xFFFFFFFF;
@@ -518,7 +526,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 						std::string assocFileName = assocFile->GetName();
 						std::string fName = GetPathToRes(assocFile->resources[0], resourceName.c_str());
 
-						uint64_t hash = CRC64(fName.c_str());
+						uint64_t hash = HashPath(fName);
+						AddDependency(dbgName, fName);
 
 						word0 = hash >> 32;
 						word1 = hash & 0xFFFFFFFF;
@@ -823,7 +832,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 
 				if (foundDecl)
 				{
-					uint64_t hash = CRC64(resourcePath.c_str());
+					uint64_t hash = HashPath(resourcePath);
+					AddDependency(dbgName, resourcePath);
 
 					word0 = hash >> 32;
 					word1 = hash & 0xFFFFFFFF;
@@ -897,7 +907,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 						fName = OTRExporter_DisplayList::GetPathToRes(res, vtxDecl->declName);
 					}
 
-					uint64_t hash = CRC64(fName.c_str());
+					uint64_t hash = HashPath(fName);
+					AddDependency(dbgName, fName);
 
 					word0 = hash >> 32;
 					word1 = hash & 0xFFFFFFFF;
@@ -908,23 +919,8 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 						MemoryStream* vtxStream = new MemoryStream();
 						BinaryWriter vtxWriter = BinaryWriter(vtxStream);
 
-						int arrCnt = 0;
-
 						auto split = StringHelper::Split(vtxDecl->declBody, "\n");
-
-						for (size_t i = 0; i < split.size(); i++)
-						{
-							std::string line = split[i];
-
-							if (StringHelper::Contains(line, "VTX("))
-								arrCnt++;
-						}
-
-						// OTRTODO: Once we aren't relying on text representations, we should call ArrayExporter...
-						OTRExporter::WriteHeader(nullptr, "", &vtxWriter, static_cast<uint32_t>(SOH::ResourceType::SOH_Array));
-
-						vtxWriter.Write((uint32_t)ZResourceType::Vertex);
-						vtxWriter.Write((uint32_t)arrCnt);
+						std::vector<OTRVtx> vertices;
 
 						auto start = std::chrono::steady_clock::now();
 
@@ -936,21 +932,35 @@ void OTRExporter_DisplayList::Save(ZResource* res, const fs::path& outPath, Bina
 							if (StringHelper::Contains(line, "VTX("))
 							{
 								auto split2 = StringHelper::Split(StringHelper::Split(StringHelper::Split(line, "VTX(")[1], ")")[0], ",");
+								OTRVtx v;
+
+								v.x = (int16_t)std::stoi(split2[0], nullptr, 10);
+								v.y = (int16_t)std::stoi(split2[1], nullptr, 10);
+								v.z = (int16_t)std::stoi(split2[2], nullptr, 10);
+								v.flag = 0;
+								v.s = (int16_t)std::stoi(split2[3], nullptr, 10);
+								v.t = (int16_t)std::stoi(split2[4], nullptr, 10);
+								v.r = (uint8_t)std::stoi(split2[5], nullptr, 10);
+								v.g = (uint8_t)std::stoi(split2[6], nullptr, 10);
+								v.b = (uint8_t)std::stoi(split2[7], nullptr, 10);
+								v.a = (uint8_t)std::stoi(split2[8], nullptr, 10);
+
+								vertices.push_back(v);
+							}
+						}
 
-								vtxWriter.Write((int16_t)std::stoi(split2[0], nullptr, 10)); // v.x
-								vtxWriter.Write((int16_t)std::stoi(split2[1], nullptr, 10)); // v.y
-								vtxWriter.Write((int16_t)std::stoi(split2[2], nullptr, 10)); // v.z
-
-								vtxWriter.Write((int16_t)0);								 // v.flag
+						// OTRTODO: Once we aren't relying on text representations, we should call ArrayExporter...
+						OTRExporter::WriteHeader(nullptr, "", &vtxWriter, static_cast<uint32_t>(SOH::ResourceType::SOH_Array),
+												 vtxRuntimeLayout ? VTX_RUNTIME_LAYOUT_VERSION : 0);
 
-								vtxWriter.Write((int16_t)std::stoi(split2[3], nullptr, 10)); // v.s
-								vtxWriter.Write((int16_t)std::stoi(split2[4], nullptr, 10)); // v.t
+						vtxWriter.Write((uint32_t)ZResourceType::Vertex);
 
-								vtxWriter.Write((uint8_t)std::stoi(split2[5], nullptr, 10)); // v.r
-								vtxWriter.Write((uint8_t)std::stoi(split2[6], nullptr, 10)); // v.g
-								vtxWriter.Write((uint8_t)std::stoi(split2[7], nullptr, 10)); // v.b
-								vtxWriter.Write((uint8_t)std::stoi(split2[8], nullptr, 10)); // v.a
-							}
+						if (vtxRuntimeLayout)
+							OTRExporter_Vtx::WriteRuntimeVtxList(&vtxWriter, vertices);
+						else
+						{
+							vtxWriter.Write((uint32_t)vertices.size());
+							WriteArray(&vtxWriter, vertices);
 						}
 
 						AddFile(fName, vtxStream->ToVector());
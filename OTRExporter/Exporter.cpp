@@ -1,11 +1,16 @@
 #include "Exporter.h"
 #include "VersionInfo.h"
+#include "Dependencies.h"
+#include "PathHash.h"
+#include "Main.h"
+#include <cassert>
 
 void OTRExporter::WriteHeader(ZResource* res, const fs::path& outPath, BinaryWriter* writer, uint32_t resType, int32_t resVersion)
 {
 	writer->Write((uint8_t)Endianness::Little); // 0x00
 	writer->Write((uint8_t)0); // 0x01
-	writer->Write((uint8_t)0); // 0x02
+	assert(writer->GetBaseAddress() == RESOURCE_HEADER_FLAGS_OFFSET);
+	writer->Write((uint8_t)(hashRefs ? RESOURCE_HEADER_FLAG_HASHED_REFS : 0)); // 0x02, header flags
 	writer->Write((uint8_t)0); // 0x03
 
 	writer->Write((uint32_t)resType); // 0x04
@@ -19,3 +24,13 @@ void OTRExporter::WriteHeader(ZResource* res, const fs::path& outPath, BinaryWri
 	while (writer->GetBaseAddress() < 0x40)
 		writer->Write((uint32_t)0); // To be used at a later date!
 }
+
+void OTRExporter::WritePath(ZResource* res, BinaryWriter* writer, const std::string& path)
+{
+	AddDependency(res, path);
+
+	if (hashRefs)
+		writer->Write(HashPath(path));
+	else
+		writer->Write(path);
+}
@@ -3,6 +3,8 @@
 #include "ZArray.h"
 #include "stdint.h"
 #include <Utils/BinaryWriter.h>
+#include <type_traits>
+#include <vector>
 #include <libultraship/bridge.h>
 #include "VersionInfo.h"
 #ifdef GAME_MM
@@ -10,8 +12,35 @@
 #elif GAME_OOT
 #include "../../games/oot/soh/resource/type/SohResourceType.h"
 #endif
+
+// Header byte 0x01 is read by libultraship as the custom asset flag. Byte 0x02 is reserved there and holds
+// exporter flags instead.
+#define RESOURCE_HEADER_FLAGS_OFFSET 0x02
+// References are written as u64 path hashes instead of strings (--hashRefs)
+#define RESOURCE_HEADER_FLAG_HASHED_REFS (1 << 0)
+
 class OTRExporter : public ZResourceExporter
 {
 protected:
 	static void WriteHeader(ZResource* res, const fs::path& outPath, BinaryWriter* writer, uint32_t resType, int32_t resVersion = 0);
+	// Writes the path (or path hash with --hashRefs) of a resource referenced by res and records the
+	// reference in the dependency graph. Empty paths are written for missing references.
+	static void WritePath(ZResource* res, BinaryWriter* writer, const std::string& path);
+
+	// Writes a contiguous run of plain values in one call. Resource writers keep native endianness,
+	// so this produces the same bytes as writing each element individually.
+	template <typename T>
+	static void WriteArray(BinaryWriter* writer, const T* data, size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "WriteArray requires plain values");
+
+		if (count != 0)
+			writer->Write((char*)data, count * sizeof(T));
+	}
+
+	template <typename T>
+	static void WriteArray(BinaryWriter* writer, const std::vector<T>& data)
+	{
+		WriteArray(writer, data.data(), data.size());
+	}
 };
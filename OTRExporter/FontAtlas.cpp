@@ -0,0 +1,211 @@
+#include "FontAtlas.h"
+
+#ifdef OTREXPORTER_FONT_ATLASES
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+struct FontGlyph {
+    uint32_t codePoint;
+    uint32_t width;
+    uint32_t height;
+    int32_t bearingX;
+    int32_t bearingY;
+    int32_t advance;
+    std::vector<uint8_t> coverage;
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+// Places the glyphs on shelves, tallest first. Returns the used height, or 0 if a glyph is wider than the atlas.
+static uint32_t PackGlyphs(std::vector<FontGlyph*>& glyphs, uint32_t width)
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t shelfHeight = 0;
+
+    for (auto glyph : glyphs) {
+        uint32_t w = glyph->width + FONT_ATLAS_PADDING * 2;
+        uint32_t h = glyph->height + FONT_ATLAS_PADDING * 2;
+
+        if (w > width)
+            return 0;
+
+        if (x + w > width) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        glyph->x = x + FONT_ATLAS_PADDING;
+        glyph->y = y + FONT_ATLAS_PADDING;
+
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+
+    return y + shelfHeight;
+}
+
+static bool BuildFontAtlas(const std::vector<char>& fontData, uint32_t pixelSize, uint32_t firstGlyph,
+                           uint32_t lastGlyph, FontAtlas& atlas)
+{
+    // FreeType objects are not shared between threads, so every size gets its own library instance
+    FT_Library library;
+
+    if (FT_Init_FreeType(&library) != 0)
+        return false;
+
+    FT_Face face;
+
+    if (FT_New_Memory_Face(library, (const FT_Byte*)fontData.data(), (FT_Long)fontData.size(), 0, &face) != 0 ||
+        FT_Set_Pixel_Sizes(face, 0, pixelSize) != 0) {
+        FT_Done_FreeType(library);
+        return false;
+    }
+
+    std::vector<FontGlyph> glyphs;
+
+    for (uint32_t codePoint = firstGlyph; codePoint <= lastGlyph; codePoint++) {
+        if (FT_Get_Char_Index(face, codePoint) == 0 || FT_Load_Char(face, codePoint, FT_LOAD_RENDER) != 0)
+            continue;
+
+        FT_GlyphSlot slot = face->glyph;
+
+        if (slot->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+            continue;
+
+        FontGlyph glyph;
+        glyph.codePoint = codePoint;
+        glyph.width = slot->bitmap.width;
+        glyph.height = slot->bitmap.rows;
+        glyph.bearingX = slot->bitmap_left;
+        glyph.bearingY = slot->bitmap_top;
+        glyph.advance = (int32_t)(slot->advance.x >> 6);
+        glyph.coverage.resize((size_t)glyph.width * glyph.height);
+
+        for (uint32_t y = 0; y < glyph.height; y++)
+            std::copy_n(slot->bitmap.buffer + (ptrdiff_t)y * slot->bitmap.pitch, glyph.width,
+                        &glyph.coverage[(size_t)y * glyph.width]);
+
+        glyphs.push_back(std::move(glyph));
+    }
+
+    int32_t ascender = (int32_t)(face->size->metrics.ascender >> 6);
+    int32_t descender = (int32_t)(face->size->metrics.descender >> 6);
+    int32_t lineHeight = (int32_t)(face->size->metrics.height >> 6);
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    std::vector<FontGlyph*> packOrder;
+    size_t area = 0;
+
+    for (auto& glyph : glyphs) {
+        packOrder.push_back(&glyph);
+        area += (size_t)(glyph.width + FONT_ATLAS_PADDING * 2) * (glyph.height + FONT_ATLAS_PADDING * 2);
+    }
+
+    std::stable_sort(packOrder.begin(), packOrder.end(),
+                     [](const FontGlyph* a, const FontGlyph* b) { return a->height > b->height; });
+
+    atlas.width = 16;
+
+    while ((size_t)atlas.width * atlas.width < area)
+        atlas.width *= 2;
+
+    for (; atlas.width <= FONT_ATLAS_MAX_SIZE; atlas.width *= 2) {
+        uint32_t usedHeight = PackGlyphs(packOrder, atlas.width);
+
+        if (usedHeight == 0)
+            continue;
+
+        atlas.height = 1;
+
+        while (atlas.height < usedHeight)
+            atlas.height *= 2;
+
+        if (atlas.height <= FONT_ATLAS_MAX_SIZE)
+            break;
+    }
+
+    if (atlas.width > FONT_ATLAS_MAX_SIZE)
+        return false;
+
+    atlas.pixelSize = pixelSize;
+    atlas.rgba.assign((size_t)atlas.width * atlas.height * 4, 0);
+
+    for (size_t i = 0; i < atlas.rgba.size(); i += 4)
+        std::fill_n(&atlas.rgba[i], 3, 0xFF);
+
+    for (const auto& glyph : glyphs) {
+        for (uint32_t y = 0; y < glyph.height; y++) {
+            for (uint32_t x = 0; x < glyph.width; x++)
+                atlas.rgba[((size_t)(glyph.y + y) * atlas.width + glyph.x + x) * 4 + 3] =
+                    glyph.coverage[(size_t)y * glyph.width + x];
+        }
+    }
+
+    MemoryStream* stream = new MemoryStream();
+    BinaryWriter writer = BinaryWriter(stream);
+
+    writer.Write((uint32_t)FONT_METRICS_MAGIC);
+    writer.Write((uint32_t)FONT_METRICS_VERSION);
+    writer.Write(pixelSize);
+    writer.Write(ascender);
+    writer.Write(descender);
+    writer.Write(lineHeight);
+    writer.Write((uint32_t)glyphs.size());
+
+    // Glyphs were rasterized in code point order
+    for (const auto& glyph : glyphs) {
+        writer.Write(glyph.codePoint);
+        writer.Write((uint16_t)glyph.x);
+        writer.Write((uint16_t)glyph.y);
+        writer.Write((uint16_t)glyph.width);
+        writer.Write((uint16_t)glyph.height);
+        writer.Write((int16_t)glyph.bearingX);
+        writer.Write((int16_t)glyph.bearingY);
+        writer.Write((int16_t)glyph.advance);
+        writer.Write((uint16_t)0);
+    }
+
+    atlas.metrics = stream->ToVector();
+    return true;
+}
+
+bool BuildFontAtlases(const std::vector<char>& fontData, const std::vector<uint32_t>& pixelSizes,
+                      uint32_t firstGlyph, uint32_t lastGlyph, std::vector<FontAtlas>& atlases)
+{
+    if (firstGlyph > lastGlyph || lastGlyph > FONT_MAX_CODE_POINT)
+        return false;
+
+    std::vector<FontAtlas> built(pixelSizes.size());
+    std::vector<std::future<bool>> results;
+
+    for (size_t i = 0; i < pixelSizes.size(); i++)
+        results.push_back(std::async(std::launch::async, BuildFontAtlas, std::cref(fontData), pixelSizes[i],
+                                     firstGlyph, lastGlyph, std::ref(built[i])));
+
+    bool success = true;
+
+    for (auto& result : results)
+        success &= result.get();
+
+    if (!success)
+        return false;
+
+    atlases = std::move(built);
+    return true;
+}
+#else
+bool BuildFontAtlases(const std::vector<char>& fontData, const std::vector<uint32_t>& pixelSizes,
+                      uint32_t firstGlyph, uint32_t lastGlyph, std::vector<FontAtlas>& atlases)
+{
+    return false;
+}
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fonts pre-rasterized at build time (--fontSize), so the game does not have to rasterize them at startup. Needs a
+// build with OTREXPORTER_FONT_ATLASES (FreeType); the raw font file is still written as a fallback.
+//
+// Each size of a font gets two entries under "<font path without extension>/<size>/": "atlas", a regular RGBA32
+// texture holding white glyphs with their coverage in alpha, and "metrics":
+//   u32 magic 'FNTM', u32 version, u32 pixel size, s32 ascender, s32 descender, s32 line height, u32 glyph count
+//   glyph table sorted by code point, 20 bytes per glyph: u32 code point, u16 x, u16 y, u16 width, u16 height,
+//   s16 bearing x, s16 bearing y, s16 advance, u16 padding
+// All metrics are in pixels.
+
+#define FONT_METRICS_MAGIC 0x464E544D
+#define FONT_METRICS_VERSION 0
+#define FONT_ATLAS_NAME "atlas"
+#define FONT_METRICS_NAME "metrics"
+
+#define FONT_ATLAS_MAX_SIZE 2048
+#define FONT_MAX_CODE_POINT 0x10FFFF
+// Empty border around each glyph so filtering does not pick up its neighbours
+#define FONT_ATLAS_PADDING 1
+// Largest pixel size whose em square still fits in an atlas with its padding
+#define FONT_MAX_PIXEL_SIZE (FONT_ATLAS_MAX_SIZE - FONT_ATLAS_PADDING * 2)
+
+struct FontAtlas {
+    uint32_t pixelSize = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+    std::vector<char> metrics;
+};
+
+// Rasterizes the glyphs from `firstGlyph` to `lastGlyph` at every size, one size per thread. Glyphs the font does not
+// have are left out. Returns false if the range is empty or past FONT_MAX_CODE_POINT, the font can not be loaded, a
+// size does not fit in an atlas, or the exporter was built without FreeType.
+bool BuildFontAtlases(const std::vector<char>& fontData, const std::vector<uint32_t>& pixelSizes,
+                      uint32_t firstGlyph, uint32_t lastGlyph, std::vector<FontAtlas>& atlases);
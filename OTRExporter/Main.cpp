@@ -20,14 +20,25 @@
 #include "AudioExporter.h"
 #include "TextureAnimationExporter.h"
 #include "CKeyFrameExporter.h"
+#include "SceneBundle.h"
+#include "ContentDedup.h"
+#include "Dependencies.h"
+#include "PathHash.h"
+#include "TextureAtlas.h"
+#include "AccessibilityTexts.h"
+#include "FontAtlas.h"
 #include <Globals.h>
 #include <Utils/DiskFile.h>
 #include <Utils/Directory.h>
 #include <Utils/MemoryStream.h>
 #include <Utils/BinaryWriter.h>
 #include <Utils/BitConverter.h>
+#include <algorithm>
+#include <atomic>
 #include <bit>
+#include <future>
 #include <mutex>
+#include <thread>
 #include <ExporterArchiveO2R.h>
 
 #include "ExporterArchiveOTR.h"
@@ -39,6 +50,34 @@ std::string archiveFileName = "oot.o2r";
 std::string customArchiveFileName = "";
 std::string customAssetsPath = "";
 std::string portVersionString = "0.0.0";
+uint32_t seqIndexInterval = 0;
+bool vtxRuntimeLayout = false;
+bool colStaticLookup = false;
+bool colReorder = false;
+bool colPlanes = false;
+bool sceneBundles = false;
+bool dedupScenes = false;
+bool depGraph = false;
+bool trackDependencies = false;
+std::vector<std::string> exportRoots;
+bool inlineLimbs = false;
+bool hashRefs = false;
+bool hashRefsTable = false;
+bool compressAnims = false;
+bool compressPlayerAnims = false;
+bool kfSoA = false;
+bool kfHermite = false;
+bool textTable = false;
+bool textIntern = false;
+bool rgba8Textures = false;
+bool blockCompressTextures = false;
+bool mipTextures = false;
+std::vector<std::string> atlasGroups;
+bool decodePng = false;
+bool accessibilityTable = false;
+std::vector<uint32_t> fontSizes;
+uint32_t fontFirstGlyph = 0x20;
+uint32_t fontLastGlyph = 0x7E;
 
 std::shared_ptr<ExporterArchive> archive;
 BinaryWriter* fileWriter;
@@ -90,11 +129,122 @@ typedef struct DataU {
     size_t size;
 } DataU;
 
+// Packs the queued atlas textures into a texture and a rect table entry per group
+static std::map<std::string, std::vector<char>> BuildTextureAtlasFiles()
+{
+    std::map<std::string, std::vector<char>> atlasFiles;
+
+    for (const auto& atlas : PackTextureAtlases())
+    {
+        MemoryStream* stream = new MemoryStream();
+        BinaryWriter writer(stream);
+
+        OTRExporter_Texture::SaveRGBA32(&writer, atlas.second.width, atlas.second.height, atlas.second.rgba);
+
+        std::string groupPath = atlas.first.ends_with("/") ? atlas.first : atlas.first + "/";
+
+        atlasFiles[groupPath + TEXTURE_ATLAS_NAME] = stream->ToVector();
+        atlasFiles[groupPath + TEXTURE_ATLAS_RECTS_NAME] = atlas.second.rects;
+    }
+
+    return atlasFiles;
+}
+
+// Adds the pre-rasterized sizes of a font next to the raw font, which stays in the archive as a fallback
+static void AddFontAtlases(const std::string& fontPath, const std::vector<uint8_t>& fontData, std::vector<Data>& dataVec)
+{
+    std::vector<FontAtlas> atlases;
+
+    if (!BuildFontAtlases(std::vector<char>(fontData.begin(), fontData.end()), fontSizes, fontFirstGlyph, fontLastGlyph, atlases))
+    {
+        printf("Could not rasterize font %s, only the font file is stored\n", fontPath.c_str());
+        return;
+    }
+
+    std::string basePath = fontPath.substr(0, fontPath.find_last_of('.'));
+
+    for (const auto& atlas : atlases)
+    {
+        MemoryStream* stream = new MemoryStream();
+        BinaryWriter writer(stream);
+
+        OTRExporter_Texture::SaveRGBA32(&writer, atlas.width, atlas.height, atlas.rgba);
+
+        std::vector<char> textureData = stream->ToVector();
+        std::string sizePath = StringHelper::Sprintf("%s/%u/", basePath.c_str(), atlas.pixelSize);
+
+        printf("Rasterized font %s at %upx into a %ux%u atlas\n", fontPath.c_str(), atlas.pixelSize, atlas.width, atlas.height);
+        dataVec.push_back({ textureData, sizePath + FONT_ATLAS_NAME, textureData.size() });
+        dataVec.push_back({ atlas.metrics, sizePath + FONT_METRICS_NAME, atlas.metrics.size() });
+    }
+}
+
+typedef struct CustomTexture {
+    std::unique_ptr<ZTexture> tex;
+    std::string texPath;
+    size_t dataIndex;
+} CustomTexture;
+
+// Saves the custom format PNGs on one worker per hardware thread, since block compressing them is the slowest part
+// of the custom archive. Each result goes to the dataVec slot reserved for it so the listing order is kept.
+static void SaveCustomTextures(std::vector<CustomTexture>& textures, std::vector<Data>& dataVec)
+{
+    if (textures.empty())
+        return;
+
+    std::atomic<size_t> next = 0;
+    std::vector<std::future<void>> workers;
+    size_t workerCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), textures.size());
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.push_back(std::async(std::launch::async, [&]() {
+            for (size_t j = next++; j < textures.size(); j = next++)
+            {
+                OTRExporter_Texture exporter;
+
+                MemoryStream* stream = new MemoryStream();
+                BinaryWriter writer(stream);
+
+                exporter.Save(textures[j].tex.get(), textures[j].texPath, &writer);
+
+                std::vector<char> fileData = stream->ToVector();
+                dataVec[textures[j].dataIndex] = { fileData, textures[j].texPath, fileData.size() };
+            }
+        }));
+    }
+
+    for (auto& worker : workers)
+        worker.get();
+}
+
+// Decodes a PNG to RGBA8 through ZAPD's texture importer
+static bool DecodePNG(const std::string& path, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba)
+{
+    ZTexture tex(nullptr);
+    Globals::Instance->buildRawTexture = true;
+    tex.FromPNG(path, TextureType::RGBA32bpp);
+
+    std::string data = tex.GetBodySourceCode();
+
+    width = tex.GetWidth();
+    height = tex.GetHeight();
+
+    if (data.size() != (size_t)width * height * 4)
+        return false;
+
+    rgba.assign(data.begin(), data.end());
+    return true;
+}
+
 static void ExporterProgramEnd()
 {
     uint32_t crc = 0xFFFFFFFF;
     const uint8_t endianness = (uint8_t)Endianness::Big;
 
+    if (compressAnims)
+        OTRExporter_Animation::PrintDecodeStats();
+
     std::vector<uint16_t> portVersion = {};
     std::vector<std::string> versionParts = StringHelper::Split(portVersionString, ".");
 
@@ -159,6 +309,61 @@ static void ExporterProgramEnd()
         auto portVersionStreamBuffer = portVersionStream->ToVector();
         archive->AddFile("portVersion", (void*)portVersionStreamBuffer.data(), portVersionStream->GetLength());
 
+        // Entries generated here. The archive only references the data, so it has to outlive the archive.
+        std::map<std::string, std::vector<char>> generatedFiles;
+
+        if (dedupScenes)
+        {
+            for (const auto& alias : GetDedupAliases())
+                files.erase(alias.first);
+        }
+
+        // Only keep what the requested roots can reach. Every file is still parsed and exported beforehand,
+        // since references are only known once the referencing resource has been written.
+        std::set<std::string> reachable;
+
+        if (!exportRoots.empty())
+        {
+            std::set<std::string> roots;
+
+            for (const auto& item : files)
+            {
+                for (const auto& root : exportRoots)
+                {
+                    if (item.first.starts_with(root))
+                        roots.insert(item.first);
+                }
+            }
+
+            reachable = GetReachable(roots);
+            size_t fileCount = files.size();
+
+            std::erase_if(files, [&](const auto& item) { return !reachable.contains(item.first); });
+
+            printf("Export roots kept %zu of %zu files.\n", files.size(), fileCount);
+        }
+
+        // The metadata tables leave out entries pruned above
+        const std::set<std::string>* keep = exportRoots.empty() ? nullptr : &reachable;
+
+        if (dedupScenes)
+        {
+            printf("Adding dedup alias manifest.\n");
+            generatedFiles["dedupAliases"] = BuildDedupAliasManifest(keep);
+        }
+
+        if (depGraph)
+        {
+            printf("Adding dependency graph.\n");
+            generatedFiles["dependencies"] = BuildDependencyGraph(keep);
+        }
+
+        if (hashRefsTable)
+        {
+            printf("Adding path hash table.\n");
+            generatedFiles["pathHashes"] = BuildPathHashTable(keep);
+        }
+
         for (const auto& item : files)
         {
             std::string fName = item.first;
@@ -174,6 +379,19 @@ static void ExporterProgramEnd()
             archive->AddFile(fName, (void*)fileData.data(),	fileData.size());
         }
 
+        if (sceneBundles)
+        {
+            printf("Adding scene bundles.\n");
+
+            generatedFiles.merge(BuildSceneBundles(files));
+        }
+
+        if (!atlasGroups.empty())
+            generatedFiles.merge(BuildTextureAtlasFiles());
+
+        for (const auto& item : generatedFiles)
+            archive->AddFile(item.first, (void*)item.second.data(), item.second.size());
+
         archive = nullptr;
     }
 
@@ -202,6 +420,7 @@ static void ExporterProgramEnd()
 
     std::vector<Data> dataVec;
     std::vector<DataU> dataVec2;
+    std::vector<CustomTexture> customTextures;
 
 
     for (const auto& item : lst)
@@ -220,23 +439,15 @@ static void ExporterProgramEnd()
 
             if (extension == "png" && (format == "rgba32" || format == "rgb5a1" || format == "i4" || format == "i8" || format == "ia4" || format == "ia8" || format == "ia16" || format == "ci4" || format == "ci8"))
             {
-                ZTexture tex(nullptr);
+                auto tex = std::make_unique<ZTexture>(nullptr);
                 Globals::Instance->buildRawTexture = true;
-                tex.FromPNG(item, ZTexture::GetTextureTypeFromString(format));
+                tex->FromPNG(item, ZTexture::GetTextureTypeFromString(format));
                 printf("customOtr->AddFile(%s)\n", StringHelper::Split(afterPath, customAssetsPath)[1].c_str());
 
-                OTRExporter_Texture exporter;
-
-                MemoryStream* stream = new MemoryStream();
-                BinaryWriter writer(stream);
-
-                exporter.Save(&tex, "", &writer);
-
-                std::string src = tex.GetBodySourceCode();
-                writer.Write((char *)src.c_str(), src.size());
-
-                std::vector<char> fileData = stream->ToVector();
-                dataVec.push_back({ fileData, StringHelper::Split(afterPath, customAssetsPath)[1], fileData.size() });
+                // Saved by SaveCustomTextures once the listing is done
+                std::string texPath = StringHelper::Split(afterPath, customAssetsPath)[1];
+                dataVec.push_back({ {}, texPath, 0 });
+                customTextures.push_back({ std::move(tex), texPath, dataVec.size() - 1 });
                 continue;
             }
         }
@@ -248,16 +459,57 @@ static void ExporterProgramEnd()
             {
                 const auto &fileData = DiskFile::ReadAllBytes(item);
                 printf("Adding accessibility texts %s\n", StringHelper::Split(item, customAssetsPath)[1].c_str());
+
+                std::vector<char> table;
+
+                if (accessibilityTable && CompileAccessibilityTexts(std::vector<char>(fileData.begin(), fileData.end()), table))
+                {
+                    dataVec.push_back({ table, StringHelper::Split(item, customAssetsPath)[1], table.size() });
+                    continue;
+                }
+
                 dataVec2.push_back({fileData,
                                      StringHelper::Split(item, customAssetsPath)[1], fileData.size() });
             }
             continue;
         }
 
+        std::string filePath = StringHelper::Split(item, customAssetsPath)[1];
+        printf("customOtr->AddFile(%s)\n", filePath.c_str());
+
+        uint32_t width, height;
+        std::vector<uint8_t> rgba;
+        bool decoded = filename.ends_with(".png") && (decodePng || GetTextureAtlasGroup(filePath) != "") &&
+                       DecodePNG(item, width, height, rgba);
+
+        if (decoded)
+            AddAtlasTexture(filePath, width, height, rgba);
+
+        // Store plain PNGs as RGBA32 textures under the same path so the game does not have to decode them
+        if (decoded && decodePng)
+        {
+            MemoryStream* stream = new MemoryStream();
+            BinaryWriter writer(stream);
+
+            OTRExporter_Texture::SaveRGBA32(&writer, width, height, rgba);
+
+            std::vector<char> textureData = stream->ToVector();
+            dataVec.push_back({ textureData, filePath, textureData.size() });
+            continue;
+        }
+
         const auto& fileData = DiskFile::ReadAllBytes(item);
-        printf("customOtr->AddFile(%s)\n", StringHelper::Split(item, customAssetsPath)[1].c_str());
-        dataVec2.push_back({ fileData, StringHelper::Split(item, customAssetsPath)[1], fileData.size() });
+        dataVec2.push_back({ fileData, filePath, fileData.size() });
+
+        if (!fontSizes.empty() && (filename.ends_with(".ttf") || filename.ends_with(".otf")))
+            AddFontAtlases(filePath, fileData, dataVec);
     }
+
+    SaveCustomTextures(customTextures, dataVec);
+
+    for (auto& atlasFile : BuildTextureAtlasFiles())
+        dataVec.push_back({ atlasFile.second, atlasFile.first, atlasFile.second.size() });
+
     for (auto& d : dataVec) {
         customOtr->AddFile(d.filePath, d.fileData.data(), d.size);
     }
@@ -287,6 +539,91 @@ static void ExporterParseArgs(int argc, char* argv[], int& i)
     } else if (arg == "--portVer") {
         portVersionString = argv[i + 1];
         i++;
+    } else if (arg == "--seqIndex") {
+        seqIndexInterval = (uint32_t)std::stoul(argv[i + 1], nullptr);
+        i++;
+    } else if (arg == "--vtxRuntimeLayout") {
+        vtxRuntimeLayout = true;
+    } else if (arg == "--colGrid") {
+        colStaticLookup = true;
+    } else if (arg == "--colReorder") {
+        colReorder = true;
+    } else if (arg == "--colPlanes") {
+        colPlanes = true;
+    } else if (arg == "--sceneBundles") {
+        sceneBundles = true;
+    } else if (arg == "--dedupScenes") {
+        dedupScenes = true;
+    } else if (arg == "--depGraph") {
+        depGraph = true;
+        trackDependencies = true;
+    } else if (arg == "--exportRoot") {
+        exportRoots.push_back(argv[i + 1]);
+        trackDependencies = true;
+        i++;
+    } else if (arg == "--inlineLimbs") {
+        inlineLimbs = true;
+    } else if (arg == "--hashRefs") {
+        hashRefs = true;
+    } else if (arg == "--hashRefsTable") {
+        hashRefs = true;
+        hashRefsTable = true;
+    } else if (arg == "--compressAnims") {
+        compressAnims = true;
+    } else if (arg == "--compressPlayerAnims") {
+        compressPlayerAnims = true;
+    } else if (arg == "--kfSoA") {
+        kfSoA = true;
+    } else if (arg == "--kfHermite") {
+        kfHermite = true;
+    } else if (arg == "--textTable") {
+        textTable = true;
+    } else if (arg == "--textIntern") {
+        textTable = true;
+        textIntern = true;
+    } else if (arg == "--rgba8Tex") {
+        rgba8Textures = true;
+    } else if (arg == "--bcTex") {
+        blockCompressTextures = true;
+    } else if (arg == "--mipTex") {
+        mipTextures = true;
+    } else if (arg == "--atlasGroup") {
+        atlasGroups.push_back(argv[i + 1]);
+        i++;
+    } else if (arg == "--decodePng") {
+        decodePng = true;
+    } else if (arg == "--accessibilityTable") {
+        accessibilityTable = true;
+    } else if (arg == "--fontSize") {
+        uint32_t size = 0;
+
+        try {
+            size = (uint32_t)std::min<unsigned long>(std::stoul(argv[i + 1], nullptr), UINT32_MAX);
+        } catch (std::invalid_argument &e) {
+            size = 0;
+        } catch (std::out_of_range &e) {
+            size = 0;
+        }
+
+        if (size != 0 && size <= FONT_MAX_PIXEL_SIZE)
+            fontSizes.push_back(size);
+        else
+            printf("Ignoring --fontSize %s, expected a pixel size from 1 to %u\n", argv[i + 1], FONT_MAX_PIXEL_SIZE);
+        i++;
+    } else if (arg == "--fontGlyphs") {
+        // Code point range as "first-last", decimal or 0x prefixed hex, limited to the Unicode range
+        std::string range = argv[i + 1];
+        size_t sepAt = range.find('-');
+        uint32_t first = std::min<unsigned long>(std::stoul(range.substr(0, sepAt), nullptr, 0), FONT_MAX_CODE_POINT);
+        uint32_t last = sepAt == std::string::npos ? first : std::min<unsigned long>(std::stoul(range.substr(sepAt + 1), nullptr, 0), FONT_MAX_CODE_POINT);
+
+        if (first <= last) {
+            fontFirstGlyph = first;
+            fontLastGlyph = last;
+        } else {
+            printf("Ignoring --fontGlyphs %s, the range is empty\n", range.c_str());
+        }
+        i++;
     }
 }
 
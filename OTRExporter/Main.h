@@ -5,5 +5,30 @@
 
 extern std::shared_ptr<ExporterArchive> archive;
 extern std::map<std::string, std::vector<char>> files;
+extern uint32_t seqIndexInterval;
+extern bool vtxRuntimeLayout;
+extern bool colStaticLookup;
+extern bool colReorder;
+extern bool colPlanes;
+extern bool dedupScenes;
+extern bool trackDependencies;
+extern bool inlineLimbs;
+extern bool hashRefs;
+extern bool hashRefsTable;
+extern bool compressAnims;
+extern bool compressPlayerAnims;
+extern bool kfSoA;
+extern bool kfHermite;
+extern bool textTable;
+extern bool textIntern;
+extern bool rgba8Textures;
+extern bool blockCompressTextures;
+extern bool mipTextures;
+extern std::vector<std::string> atlasGroups;
+extern bool decodePng;
+extern bool accessibilityTable;
+extern std::vector<uint32_t> fontSizes;
+extern uint32_t fontFirstGlyph;
+extern uint32_t fontLastGlyph;
 
 void AddFile(std::string fName, std::vector<char> data);
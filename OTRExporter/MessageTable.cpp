@@ -0,0 +1,59 @@
+#include "MessageTable.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+std::vector<size_t> SortMessagesById(const std::vector<uint16_t>& ids)
+{
+    std::vector<size_t> order(ids.size());
+
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ids[a] < ids[b]; });
+
+    return order;
+}
+
+std::vector<MessageString> BuildMessageBlob(const std::vector<std::string>& strings, bool intern,
+                                            std::vector<char>& blob)
+{
+    std::vector<MessageString> placed;
+    std::map<std::string, MessageString> interned;
+
+    for (const auto& str : strings) {
+        if (intern) {
+            auto it = interned.find(str);
+
+            if (it != interned.end()) {
+                placed.push_back(it->second);
+                continue;
+            }
+        }
+
+        MessageString entry;
+        entry.offset = (uint32_t)blob.size();
+        entry.length = (uint32_t)str.size();
+
+        blob.insert(blob.end(), str.begin(), str.end());
+        placed.push_back(entry);
+
+        if (intern)
+            interned.emplace(str, entry);
+    }
+
+    return placed;
+}
+
+MessageTableLayout BuildMessageTable(const std::vector<uint16_t>& ids, const std::vector<std::string>& strings,
+                                     bool intern)
+{
+    MessageTableLayout layout;
+    layout.order = SortMessagesById(ids);
+
+    std::vector<std::string> sortedStrings;
+
+    for (size_t i : layout.order)
+        sortedStrings.push_back(strings[i]);
+
+    layout.strings = BuildMessageBlob(sortedStrings, intern, layout.blob);
+    return layout;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shared layout for message table text resources. Messages are stored as a table sorted by ID, so the runtime can
+// binary search it, followed by one string blob the table entries point into.
+#define TEXT_MESSAGE_TABLE_VERSION 1
+
+struct MessageString {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Returns the message indices ordered by ID. Messages with the same ID keep their original order, so a lookup
+// finding the first match returns the same message as walking the unsorted list.
+std::vector<size_t> SortMessagesById(const std::vector<uint16_t>& ids);
+
+// Appends `strings` to `blob` and returns where each one was placed. With `intern`, identical strings are stored
+// once and share their offset.
+std::vector<MessageString> BuildMessageBlob(const std::vector<std::string>& strings, bool intern,
+                                            std::vector<char>& blob);
+
+struct MessageTableLayout {
+    // Message indices in table order
+    std::vector<size_t> order;
+    // String placement of each table entry, in table order
+    std::vector<MessageString> strings;
+    std::vector<char> blob;
+};
+
+// Sorts messages by ID and places their strings in one blob. `ids` and `strings` are in message order.
+MessageTableLayout BuildMessageTable(const std::vector<uint16_t>& ids, const std::vector<std::string>& strings,
+                                     bool intern);
+
+// Same as above for any message list with `id` and `msg` members (OoT and MM messages).
+template <typename Message>
+MessageTableLayout BuildMessageTable(const std::vector<Message>& messages, bool intern)
+{
+    std::vector<uint16_t> ids;
+    std::vector<std::string> strings;
+
+    for (const auto& message : messages) {
+        ids.push_back((uint16_t)message.id);
+        strings.push_back(message.msg);
+    }
+
+    return BuildMessageTable(ids, strings, intern);
+}
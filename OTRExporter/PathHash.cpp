@@ -0,0 +1,48 @@
+#include "PathHash.h"
+#include "Main.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <ship/utils/StrHash64.h>
+#include <map>
+#include <mutex>
+
+static std::mutex pathHashMutex;
+static std::map<uint64_t, std::string> pathHashes;
+
+uint64_t HashPath(const std::string& path)
+{
+    if (path == "")
+        return 0;
+
+    std::string target = path.starts_with("__OTR__") ? path.substr(7) : path;
+    uint64_t hash = CRC64(target.c_str());
+
+    if (hashRefsTable) {
+        std::unique_lock Lock(pathHashMutex);
+        pathHashes.emplace(hash, target);
+    }
+
+    return hash;
+}
+
+std::vector<char> BuildPathHashTable(const std::set<std::string>* keep)
+{
+    std::unique_lock Lock(pathHashMutex);
+
+    std::map<uint64_t, std::string> table = pathHashes;
+
+    if (keep != nullptr)
+        std::erase_if(table, [&](const auto& item) { return !keep->contains(item.second); });
+
+    MemoryStream* tableStream = new MemoryStream();
+    BinaryWriter tableWriter = BinaryWriter(tableStream);
+
+    tableWriter.Write((uint32_t)table.size());
+
+    for (const auto& item : table) {
+        tableWriter.Write(item.first);
+        tableWriter.Write(item.second);
+    }
+
+    return tableStream->ToVector();
+}
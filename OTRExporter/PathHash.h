@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+// Hash stored in place of a reference path when references are hashed. The "__OTR__" marker is not part of the
+// archive path and is dropped before hashing; empty paths hash to 0.
+uint64_t HashPath(const std::string& path);
+
+// Serialized table of every hashed path for debugging (u32 count, then u64 hash and path string pairs sorted by
+// hash). Paths are only collected when the table was requested. With `keep`, paths not in it are left out.
+std::vector<char> BuildPathHashTable(const std::set<std::string>* keep = nullptr);
@@ -1,18 +1,62 @@
 #include "PlayerAnimationExporter.h"
 #include <libultraship/bridge.h>
+#include "AnimationCompression.h"
+#include "Main.h"
+
+// Compresses the animation and checks it decodes to the original data. Falls back to the legacy layout if that
+// fails or the result would not be smaller.
+static bool CompressAnimation(ZPlayerAnimationData* anim, CompressedPlayerAnimation& compressed)
+{
+	std::vector<int16_t> limbRotData(anim->limbRotData.begin(), anim->limbRotData.end());
+
+	if (!CompressPlayerAnimation(limbRotData, (uint32_t)anim->frameCount, PLAYER_ANIMATION_CHECKPOINT_INTERVAL, compressed))
+		return false;
+
+	if (DecodePlayerAnimation(compressed) != limbRotData)
+	{
+		printf("Player animation %s did not survive compression, writing it uncompressed\n", anim->GetName().c_str());
+		return false;
+	}
+
+	size_t compressedSize = compressed.checkpointOffsets.size() * (sizeof(uint32_t) + sizeof(uint8_t)) +
+	                        compressed.checkpointValues.size() * sizeof(int16_t) + compressed.deltaStream.size();
+
+	return compressedSize < limbRotData.size() * sizeof(int16_t);
+}
 
 void OTRExporter_PlayerAnimationExporter::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZPlayerAnimationData* anim = (ZPlayerAnimationData*)res;
 
-	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_PlayerAnimation));
+	CompressedPlayerAnimation compressed;
+	bool compress = compressPlayerAnims && CompressAnimation(anim, compressed);
+
+	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_PlayerAnimation), compress ? PLAYER_ANIMATION_COMPRESSED_VERSION : 0);
 
 	auto start = std::chrono::steady_clock::now();
 	
 	writer->Write((uint32_t)anim->limbRotData.size());
 
-	for (size_t i = 0; i < anim->limbRotData.size(); i++)
-		writer->Write(anim->limbRotData[i]);
+	if (compress)
+	{
+		writer->Write(compressed.frameCount);
+		writer->Write(compressed.valuesPerFrame);
+		writer->Write(compressed.checkpointInterval);
+
+		writer->Write((uint32_t)compressed.checkpointOffsets.size());
+		WriteArray(writer, compressed.checkpointOffsets);
+		WriteArray(writer, compressed.checkpointValues);
+
+		writer->Write((uint32_t)compressed.deltaStream.size());
+		WriteArray(writer, compressed.deltaStream);
+
+		// Last so the s16 data above stays 2 byte aligned
+		WriteArray(writer, compressed.spanWidths);
+	}
+	else
+	{
+		WriteArray(writer, anim->limbRotData);
+	}
 
 	auto end = std::chrono::steady_clock::now();
 	size_t diff = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -6,6 +6,11 @@
 #include "Exporter.h"
 #include <Utils/BinaryWriter.h>
 
+// Version 1 of player animations stores the frame data in the compressed layout from AnimationCompression.h,
+// with a full checkpoint frame every PLAYER_ANIMATION_CHECKPOINT_INTERVAL frames.
+#define PLAYER_ANIMATION_COMPRESSED_VERSION 1
+#define PLAYER_ANIMATION_CHECKPOINT_INTERVAL 8
+
 class OTRExporter_PlayerAnimationExporter : public OTRExporter
 {
 public:
@@ -40,10 +40,37 @@
 #include <ZRoom/Commands/SetMinimapChests.h>
 #include "TextureAnimationExporter.h"
 #include "PathExporter.h"
+#include "ContentDedup.h"
+#include <map>
+#include <mutex>
 #undef FindResource
 
+// Alternate headers serialized by the scene that lists them (--dedupScenes). The header's own export writes these
+// bytes instead of running Save again, so the header is serialized and its side effects (cutscene files, dedup and
+// dependency records) happen once.
+static std::mutex serializedHeadersMutex;
+static std::map<ZResource*, std::vector<char>> serializedHeaders;
 
 void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
+{
+    if (dedupScenes)
+    {
+        std::unique_lock Lock(serializedHeadersMutex);
+        auto serialized = serializedHeaders.find(res);
+
+        if (serialized != serializedHeaders.end())
+        {
+            writer->Write(serialized->second.data(), serialized->second.size());
+            serializedHeaders.erase(serialized);
+            return;
+        }
+    }
+
+    SaveRoom(res, outPath, writer);
+}
+
+
+void OTRExporter_Room::SaveRoom(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
     ZRoom* room = (ZRoom*)res;
 
@@ -215,14 +242,14 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
                 Declaration* dListDeclXlu = poly->parent->GetDeclaration(GETSEGOFFSET(test->xlu));
 
                 if (test->opa != 0)
-                    writer->Write(StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(res).c_str(), dListDeclOpa->declName.c_str()));
+                    WritePath(res, writer, StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(res).c_str(), dListDeclOpa->declName.c_str()));
                 else
-                    writer->Write("");
+                    WritePath(res, writer, "");
 
                 if (test->xlu != 0)
-                    writer->Write(StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(res).c_str(), dListDeclXlu->declName.c_str()));
+                    WritePath(res, writer, StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(res).c_str(), dListDeclXlu->declName.c_str()));
                 else
-                    writer->Write("");
+                    WritePath(res, writer, "");
 
                 if (poly->format == 2)
                 {
@@ -235,7 +262,7 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
 
                         Declaration* bgDecl = poly->parent->GetDeclarationRanged(GETSEGOFFSET(poly->multiList[i].source));
 
-                        writer->Write(OTRExporter_DisplayList::GetPathToRes(poly->multiList[i].sourceBackground, bgDecl->declName));
+                        WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(poly->multiList[i].sourceBackground, bgDecl->declName));
 
                         writer->Write(poly->multiList[i].unk_0C);
                         writer->Write(poly->multiList[i].tlut);
@@ -256,7 +283,7 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
 
                     Declaration* bgDecl = poly->parent->GetDeclarationRanged(GETSEGOFFSET(poly->single.source));
 
-                    writer->Write(OTRExporter_DisplayList::GetPathToRes(poly->single.sourceBackground, bgDecl->declName));
+                    WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(poly->single.sourceBackground, bgDecl->declName));
 
                     writer->Write(poly->single.unk_0C);
                     writer->Write(poly->single.tlut);
@@ -362,7 +389,7 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
                         roomName = OTRExporter_DisplayList::GetPathToRes(room, StringHelper::Sprintf("%s_room_%02d", StringHelper::Split(room->GetName(), "_scene")[0].c_str(), i));
                 }
 
-                writer->Write(roomName);
+                WritePath(res, writer, roomName);
                 writer->Write(cmdRoom->romfile->rooms[i].virtualAddressStart);
                 writer->Write(cmdRoom->romfile->rooms[i].virtualAddressEnd);
             }
@@ -374,7 +401,7 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
 
             Declaration* colHeaderDecl = room->parent->GetDeclaration(cmdCollHeader->segmentOffset);
             std::string path = OTRExporter_DisplayList::GetPathToRes(room, colHeaderDecl->declName);
-            writer->Write(path);
+            WritePath(res, writer, path);
         }
         break;
         case RoomCommand::SetEntranceList:
@@ -431,11 +458,34 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
                 std::string headerName = "";
                 bool foundDecl = Globals::Instance->GetSegmentedPtrName(seg, room->parent, "", headerName, res->parent->workerID);
                 if (headerName == "NULL")
-                    writer->Write("");
+                    WritePath(res, writer, "");
                 else
                 {
                     std::string name = OTRExporter_DisplayList::GetPathToRes(room, headerName);
-                    writer->Write(name);
+
+                    // Alternate headers are exported as their own resources after the scene. They are serialized
+                    // here to find out whether an identical header was already written, and the header's own
+                    // export then reuses these bytes.
+                    if (dedupScenes)
+                    {
+                        ZResource* header = room->parent->FindResource(seg & 0x00FFFFFF);
+
+                        if (header != nullptr && (header->GetResourceType() == ZResourceType::Room ||
+                                                  header->GetResourceType() == ZResourceType::AltHeader))
+                        {
+                            MemoryStream* headerStream = new MemoryStream();
+                            BinaryWriter headerWriter = BinaryWriter(headerStream);
+                            SaveRoom(header, outPath, &headerWriter);
+
+                            std::vector<char> headerData = headerStream->ToVector();
+                            name = DedupResource(room->parent, name, headerData);
+
+                            std::unique_lock Lock(serializedHeadersMutex);
+                            serializedHeaders[header] = std::move(headerData);
+                        }
+                    }
+
+                    WritePath(res, writer, name);
                 }
             }
         }
@@ -472,31 +522,42 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
                 for (size_t i = 0; i < cmdSetCutscenes->cutsceneEntries.size(); i++) {
                     Globals::Instance->GetSegmentedPtrName(cmdSetCutscenes->cutsceneEntries[i].segmentPtr, room->parent, "CutsceneData", listName, res->parent->workerID);
                     std::string fName = OTRExporter_DisplayList::GetPathToRes(room, listName);
-                    writer->Write(fName);
-                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].exit);
-                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].entrance);
-                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].flag);
-                    
+
                     MemoryStream* csStream = new MemoryStream();
                     BinaryWriter csWriter = BinaryWriter(csStream);
                     OTRExporter_Cutscene cs;
                     ZResource* newCs = res->parent->FindResource(cmdSetCutscenes->cutsceneEntries[i].segmentPtr & 0x00FFFFFF);
                     cs.Save((ZCutscene*)newCs, "", &csWriter);
 
-                    AddFile(fName, csStream->ToVector());
+                    auto csData = csStream->ToVector();
+
+                    if (dedupScenes)
+                        fName = DedupResource(room->parent, fName, csData);
+
+                    WritePath(res, writer, fName);
+                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].exit);
+                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].entrance);
+                    writer->Write(cmdSetCutscenes->cutsceneEntries[i].flag);
+
+                    AddFile(fName, csData);
                 }
             }
             else {
                 Globals::Instance->GetSegmentedPtrName(cmdSetCutscenes->cmdArg2, room->parent, "CutsceneData", listName, res->parent->workerID);
                 std::string fName = OTRExporter_DisplayList::GetPathToRes(room, listName);
-                writer->Write(fName);
 
                 MemoryStream* csStream = new MemoryStream();
                 BinaryWriter csWriter = BinaryWriter(csStream);
                 OTRExporter_Cutscene cs;
                 cs.Save(cmdSetCutscenes->cutscenes[0], "", &csWriter);
 
-                AddFile(fName, csStream->ToVector());
+                auto csData = csStream->ToVector();
+
+                if (dedupScenes)
+                    fName = DedupResource(room->parent, fName, csData);
+
+                WritePath(res, writer, fName);
+                AddFile(fName, csData);
             }
         }
             break;
@@ -506,12 +567,15 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
 
             writer->Write((uint32_t)cmdSetPathways->pathwayList.pathways.size());
 
-            for (size_t i = 0; i < cmdSetPathways->pathwayList.pathways.size(); i++)
+            // The path resource holds the whole pathway list, so it is written once under the first pathway's
+            // name and every entry refers to that copy.
+            std::string path = "";
+
+            if (!cmdSetPathways->pathwayList.pathways.empty())
             {
-                Declaration* decl = room->parent->GetDeclaration(GETSEGOFFSET(cmdSetPathways->pathwayList.pathways[i].listSegmentAddress));
+                Declaration* decl = room->parent->GetDeclaration(GETSEGOFFSET(cmdSetPathways->pathwayList.pathways[0].listSegmentAddress));
                 //std::string path = StringHelper::Sprintf("%s\\%s", OTRExporter_DisplayList::GetParentFolderName(res).c_str(), decl->varName.c_str());
-                std::string path = OTRExporter_DisplayList::GetPathToRes(room, decl->declName);
-                writer->Write(path);
+                path = OTRExporter_DisplayList::GetPathToRes(room, decl->declName);
 
                 MemoryStream* pathStream = new MemoryStream();
                 BinaryWriter pathWriter = BinaryWriter(pathStream);
@@ -520,6 +584,9 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
 
                 AddFile(path, pathStream->ToVector());
             }
+
+            for (size_t i = 0; i < cmdSetPathways->pathwayList.pathways.size(); i++)
+                WritePath(res, writer, path);
         }
             break;
         case RoomCommand::EndMarker:
@@ -550,7 +617,7 @@ void OTRExporter_Room::Save(ZResource* res, const fs::path& outPath, BinaryWrite
             Globals::Instance->GetSegmentedPtrName(cmd->cmdArg2, cmd->parent, "AnimatedMaterial", listName,
                 res->parent->workerID);
             listName = OTRExporter_DisplayList::GetPathToRes(room, listName);
-            writer->Write(listName);
+            WritePath(res, writer, listName);
 
             MemoryStream* animatedMatStream = new MemoryStream();
             BinaryWriter animatedMatWriter = BinaryWriter(animatedMatStream);
@@ -619,18 +686,18 @@ void OTRExporter_Room::WritePolyDList(BinaryWriter* writer, ZRoom* room, RoomSha
         if (dlist->opaDList != nullptr)
         {
             auto opaDecl = room->parent->GetDeclaration(GETSEGOFFSET(dlist->opaDList->GetRawDataIndex()));
-            writer->Write(StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(room).c_str(), opaDecl->declName.c_str()));
+            WritePath(room, writer, StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(room).c_str(), opaDecl->declName.c_str()));
         }
         else
-            writer->Write("");
+            WritePath(room, writer, "");
 
         if (dlist->xluDList != nullptr)
         {
             auto xluDecl = room->parent->GetDeclaration(GETSEGOFFSET(dlist->xluDList->GetRawDataIndex()));
-            writer->Write(StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(room).c_str(), xluDecl->declName.c_str()));
+            WritePath(room, writer, StringHelper::Sprintf("%s/%s", OTRExporter_DisplayList::GetParentFolderName(room).c_str(), xluDecl->declName.c_str()));
         }
         else
-            writer->Write("");
+            WritePath(room, writer, "");
         break;
     }
 }
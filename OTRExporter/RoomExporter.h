@@ -12,4 +12,7 @@ class OTRExporter_Room : public OTRExporter
 public:
 	void WritePolyDList(BinaryWriter* writer, ZRoom* room, RoomShapeDListsEntry* dlist);
 	virtual void Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer) override;
+
+private:
+	void SaveRoom(ZResource* res, const fs::path& outPath, BinaryWriter* writer);
 };
\ No newline at end of file
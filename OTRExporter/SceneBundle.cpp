@@ -0,0 +1,82 @@
+#include "SceneBundle.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <ship/utils/StrHash64.h>
+#include <algorithm>
+
+// Scene and room files of the same scene do not always share a folder (MM rooms drop the "_scene" suffix),
+// so entries are grouped by their folder with that suffix removed.
+static std::string GetSceneBundlePath(const std::string& filePath)
+{
+    if (!filePath.starts_with("scenes/"))
+        return "";
+
+    size_t slash = filePath.rfind('/');
+
+    if (slash == std::string::npos)
+        return "";
+
+    std::string folder = filePath.substr(0, slash);
+
+    if (folder.ends_with("_scene"))
+        folder = folder.substr(0, folder.size() - 6);
+
+    return folder + "_scene/" + SCENE_BUNDLE_NAME;
+}
+
+std::map<std::string, std::vector<char>> BuildSceneBundles(const std::map<std::string, std::vector<char>>& files)
+{
+    struct BundleEntry {
+        uint64_t hash;
+        const std::vector<char>* data;
+    };
+
+    std::map<std::string, std::vector<BundleEntry>> groups;
+
+    for (const auto& item : files) {
+        std::string bundlePath = GetSceneBundlePath(item.first);
+
+        if (bundlePath != "")
+            groups[bundlePath].push_back({ CRC64(item.first.c_str()), &item.second });
+    }
+
+    std::map<std::string, std::vector<char>> bundles;
+
+    for (auto& group : groups) {
+        auto& entries = group.second;
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const BundleEntry& a, const BundleEntry& b) { return a.hash < b.hash; });
+
+        MemoryStream* bundleStream = new MemoryStream();
+        BinaryWriter bundleWriter = BinaryWriter(bundleStream);
+
+        bundleWriter.Write((uint32_t)SCENE_BUNDLE_MAGIC);
+        bundleWriter.Write((uint32_t)SCENE_BUNDLE_VERSION);
+        bundleWriter.Write((uint32_t)entries.size());
+
+        uint32_t offset = 12 + (uint32_t)entries.size() * 16;
+
+        for (const auto& entry : entries) {
+            offset = (offset + 7) & ~7;
+
+            bundleWriter.Write(entry.hash);
+            bundleWriter.Write(offset);
+            bundleWriter.Write((uint32_t)entry.data->size());
+
+            offset += (uint32_t)entry.data->size();
+        }
+
+        for (const auto& entry : entries) {
+            while (bundleWriter.GetBaseAddress() % 8 != 0)
+                bundleWriter.Write((uint8_t)0);
+
+            bundleWriter.Write((char*)entry.data->data(), entry.data->size());
+        }
+
+        bundles[group.first] = bundleStream->ToVector();
+        printf("Bundled %zu entries into %s\n", entries.size(), group.first.c_str());
+    }
+
+    return bundles;
+}
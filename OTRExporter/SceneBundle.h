@@ -0,0 +1,20 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Scene bundles pack every resource stored under a scene's folder into one archive entry, so the runtime can
+// read a whole scene with a single fetch. The individual entries are still written; bundles are an addition.
+//
+// Layout (native endian):
+//   u32 magic 'SBDL', u32 version, u32 entry count
+//   entry table sorted by hash: u64 CRC64 of the full resource path, u32 data offset, u32 data size
+//   resource data, each entry starting on an 8 byte boundary. Offsets are relative to the start of the bundle.
+
+#define SCENE_BUNDLE_MAGIC 0x5342444C
+#define SCENE_BUNDLE_VERSION 0
+#define SCENE_BUNDLE_NAME "sceneBundle"
+
+// Returns the bundles to add to the archive, keyed by archive path.
+std::map<std::string, std::vector<char>> BuildSceneBundles(const std::map<std::string, std::vector<char>>& files);
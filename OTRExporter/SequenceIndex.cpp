@@ -0,0 +1,1095 @@
+#include "SequenceIndex.h"
+
+namespace {
+
+// Upper bound on the walked length, about 20 minutes of music at normal tempos.
+constexpr uint32_t kMaxTicks = 0x20000;
+// Commands a single script may run without yielding before it is considered stuck.
+constexpr int kMaxCommandsPerStep = 0x1000;
+
+constexpr uint8_t NA = 0xFF;
+
+// Argument sizes in bytes for channel commands 0xB0-0xF1, mirroring the game's instruction argument table.
+// Commands marked NA are not followed by the walker.
+const uint8_t sChannelArgs[0x42][3] = {
+    { 2 },       // 0xB0 set filter
+    { 0 },       // 0xB1 clear filter
+    { 2 },       // 0xB2 dynread sequence large
+    { 1 },       // 0xB3 load filter
+    { 0 },       // 0xB4 set dyntable large
+    { 0 },       // 0xB5 read dyntable large
+    { 0 },       // 0xB6 read dyntable
+    { 2 },       // 0xB7 random range large
+    { 1 },       // 0xB8 random value
+    { 1 },       // 0xB9 velocity random variance
+    { 1 },       // 0xBA gate time random variance
+    { 1, 2 },    // 0xBB comb filter
+    { 2 },       // 0xBC add large
+    { NA },      // 0xBD
+    { NA },      // 0xBE
+    { NA },      // 0xBF
+    { NA },      // 0xC0
+    { 1 },       // 0xC1 set instrument
+    { 2 },       // 0xC2 set dyntable
+    { 0 },       // 0xC3 large notes off
+    { 0 },       // 0xC4 large notes on
+    { 0 },       // 0xC5 dyn set dyntable
+    { 1 },       // 0xC6 set soundfont
+    { 1, 2 },    // 0xC7 write into sequence
+    { 1 },       // 0xC8 subtract
+    { 1 },       // 0xC9 bit and
+    { 1 },       // 0xCA mute behavior
+    { 2 },       // 0xCB read sequence
+    { 1 },       // 0xCC set value
+    { 1 },       // 0xCD disable channel
+    { 2 },       // 0xCE set large value
+    { 2 },       // 0xCF write large into sequence
+    { 1 },       // 0xD0 stereo headset effects
+    { 1 },       // 0xD1 note allocation policy
+    { 1 },       // 0xD2 sustain
+    { 1 },       // 0xD3 large bend pitch
+    { 1 },       // 0xD4 reverb
+    { 1 },       // 0xD5
+    { 1 },       // 0xD6
+    { 1 },       // 0xD7 vibrato rate
+    { 1 },       // 0xD8 vibrato extent
+    { 1 },       // 0xD9 decay index
+    { 2 },       // 0xDA envelope
+    { 1 },       // 0xDB transpose
+    { 1 },       // 0xDC pan mix
+    { 1 },       // 0xDD pan
+    { 2 },       // 0xDE freq scale
+    { 1 },       // 0xDF volume
+    { 1 },       // 0xE0 volume scale
+    { 1, 1, 1 }, // 0xE1 vibrato rate linear
+    { 1, 1, 1 }, // 0xE2 vibrato extent linear
+    { 1 },       // 0xE3 vibrato delay
+    { 0 },       // 0xE4 dyncall
+    { 1 },       // 0xE5 reverb index
+    { 1 },       // 0xE6 book offset
+    { 2 },       // 0xE7 load channel parameters
+    { 0 },       // 0xE8 set channel parameters, reads its own 8 bytes
+    { 1 },       // 0xE9 note priority
+    { 0 },       // 0xEA stop script
+    { 1, 1 },    // 0xEB soundfont and instrument
+    { 0 },       // 0xEC reset vibrato
+    { 1 },       // 0xED hilo gain
+    { 1 },       // 0xEE small bend pitch
+    { 2, 1 },    // 0xEF
+    { 0 },       // 0xF0 unreserve notes
+    { 1 },       // 0xF1 reserve notes
+};
+
+struct ScriptState {
+    uint16_t pc = 0;
+    uint16_t stack[4] = {};
+    uint8_t remLoopIters[4] = {};
+    uint8_t depth = 0;
+    int8_t value = 0;
+};
+
+struct LayerState {
+    bool allocated = false;
+    bool enabled = false;
+    bool finished = false;
+    ScriptState script;
+    int32_t delay = 0;
+    uint16_t lastDelay = 0;
+    uint16_t shortNoteDefaultPlayPercentage = 0x80;
+    uint8_t instrument = 0;
+    int8_t transposition = 0;
+};
+
+struct ChannelState {
+    bool enabled = false;
+    bool stopScript = false;
+    bool largeNotes = false;
+    ScriptState script;
+    int32_t delay = 0;
+    uint16_t dynTable = 0;
+    uint16_t largeValue = 0;
+    uint8_t fontId = 0xFF;
+    uint8_t instrument = 0;
+    uint8_t volume = 0;
+    uint8_t pan = 0;
+    int8_t transposition = 0;
+    int8_t soundScriptIO[8] = {};
+    LayerState layers[4];
+};
+
+class SequenceWalker {
+public:
+    explicit SequenceWalker(const std::vector<char>& seqData)
+        : mData(seqData.begin(), seqData.end()), mFirstTick(seqData.size(), SEQ_INDEX_NO_LOOP) {
+        for (auto& io : mSoundScriptIO)
+            io = -1;
+    }
+
+    bool Run(uint32_t interval, SeqIndex& index) {
+        index.interval = interval;
+        index.checkpoints.clear();
+
+        for (uint32_t tick = 0; tick < kMaxTicks; tick++) {
+            if (tick % interval == 0)
+                index.checkpoints.push_back(Capture(tick));
+
+            if (!StepSequence(tick))
+                return false;
+
+            for (auto& channel : mChannels) {
+                if (channel.enabled && !StepChannel(channel))
+                    return false;
+            }
+
+            if (mLooped) {
+                index.loopStartTick = mLoopStartTick;
+                index.loopEndTick = tick;
+                break;
+            }
+
+            if (mSeqFinished && !AnyChannelEnabled())
+                break;
+        }
+
+        return true;
+    }
+
+private:
+    bool InRange(uint32_t offset, uint32_t size) const {
+        return offset + size <= mData.size();
+    }
+
+    bool ReadU8(ScriptState& state, uint8_t& out) {
+        if (!InRange(state.pc, 1))
+            return false;
+
+        out = mData[state.pc++];
+        return true;
+    }
+
+    bool ReadU16(ScriptState& state, uint16_t& out) {
+        if (!InRange(state.pc, 2))
+            return false;
+
+        out = (uint16_t)((mData[state.pc] << 8) | mData[state.pc + 1]);
+        state.pc += 2;
+        return true;
+    }
+
+    bool ReadCompressedU16(ScriptState& state, uint16_t& out) {
+        uint8_t hi;
+
+        if (!ReadU8(state, hi))
+            return false;
+
+        if (hi & 0x80) {
+            uint8_t lo;
+
+            if (!ReadU8(state, lo))
+                return false;
+
+            out = (uint16_t)(((hi & 0x7F) << 8) | lo);
+        } else {
+            out = hi;
+        }
+
+        return true;
+    }
+
+    bool PeekU16(uint32_t offset, uint16_t& out) const {
+        if (!InRange(offset, 2))
+            return false;
+
+        out = (uint16_t)((mData[offset] << 8) | mData[offset + 1]);
+        return true;
+    }
+
+    // Reads the argument of a control flow command (0xF2-0xFF).
+    bool ReadFlowParam(ScriptState& state, uint8_t cmd, uint16_t& param) {
+        param = 0;
+
+        switch (cmd) {
+            case 0xF2:
+            case 0xF3:
+            case 0xF4:
+            case 0xF8: {
+                uint8_t value;
+
+                if (!ReadU8(state, value))
+                    return false;
+
+                param = value;
+                return true;
+            }
+            case 0xF5:
+            case 0xF9:
+            case 0xFA:
+            case 0xFB:
+            case 0xFC:
+                return ReadU16(state, param);
+            default:
+                return true;
+        }
+    }
+
+    // Runs a control flow command. Returns the delay it requests, 0 to keep going, -1 when the script ended
+    // and -2 when the script is malformed.
+    int32_t HandleFlowControl(ScriptState& state, uint8_t cmd, uint16_t param) {
+        switch (cmd) {
+            case 0xFF: // end
+                if (state.depth == 0)
+                    return -1;
+
+                state.pc = state.stack[--state.depth];
+                break;
+            case 0xFD: { // delay
+                uint16_t delay;
+
+                if (!ReadCompressedU16(state, delay))
+                    return -2;
+
+                return delay;
+            }
+            case 0xFE: // delay1
+                return 1;
+            case 0xFC: // call
+                if (state.depth >= 4)
+                    return -2;
+
+                state.stack[state.depth++] = state.pc;
+                state.pc = param;
+                break;
+            case 0xF8: // loop
+                if (state.depth >= 4)
+                    return -2;
+
+                state.remLoopIters[state.depth] = (uint8_t)param;
+                state.stack[state.depth++] = state.pc;
+                break;
+            case 0xF7: // loopend
+                if (state.depth == 0)
+                    return -2;
+
+                state.remLoopIters[state.depth - 1]--;
+
+                if (state.remLoopIters[state.depth - 1] != 0)
+                    state.pc = state.stack[state.depth - 1];
+                else
+                    state.depth--;
+                break;
+            case 0xF6: // break
+                if (state.depth == 0)
+                    return -2;
+
+                state.depth--;
+                break;
+            case 0xF5: // bgez
+                if (state.value >= 0)
+                    state.pc = param;
+                break;
+            case 0xF9: // bltz
+                if (state.value < 0)
+                    state.pc = param;
+                break;
+            case 0xFA: // beqz
+                if (state.value == 0)
+                    state.pc = param;
+                break;
+            case 0xFB: // jump
+                state.pc = param;
+                break;
+            case 0xF4: // rjump
+                state.pc += (int8_t)param;
+                break;
+            case 0xF3: // rbeqz
+                if (state.value == 0)
+                    state.pc += (int8_t)param;
+                break;
+            case 0xF2: // rbltz
+                if (state.value < 0)
+                    state.pc += (int8_t)param;
+                break;
+        }
+
+        return 0;
+    }
+
+    bool AnyChannelEnabled() const {
+        for (const auto& channel : mChannels) {
+            if (channel.enabled)
+                return true;
+        }
+
+        return false;
+    }
+
+    void EnableChannel(uint8_t index, uint16_t pc) {
+        ChannelState& channel = mChannels[index & 0xF];
+
+        channel = ChannelState();
+        channel.enabled = true;
+        channel.script.pc = pc;
+
+        for (auto& io : channel.soundScriptIO)
+            io = -1;
+    }
+
+    void DisableChannel(ChannelState& channel) {
+        for (auto& layer : channel.layers)
+            layer = LayerState();
+
+        channel.enabled = false;
+    }
+
+    bool StepSequence(uint32_t tick) {
+        if (mSeqFinished)
+            return true;
+
+        if (mSeqDelay > 1) {
+            mSeqDelay--;
+            return true;
+        }
+
+        ScriptState& state = mSeqScript;
+
+        for (int i = 0; i < kMaxCommandsPerStep; i++) {
+            uint16_t cmdPc = state.pc;
+            uint8_t cmd;
+
+            if (!InRange(cmdPc, 1))
+                return false;
+
+            if (mFirstTick[cmdPc] == SEQ_INDEX_NO_LOOP)
+                mFirstTick[cmdPc] = tick;
+
+            ReadU8(state, cmd);
+
+            if (cmd >= 0xF2) {
+                uint16_t param;
+
+                if (!ReadFlowParam(state, cmd, param))
+                    return false;
+
+                // An unconditional backwards jump in the sequence script is where the song loops.
+                if (cmd == 0xFB || cmd == 0xF4) {
+                    uint16_t target = (cmd == 0xFB) ? param : (uint16_t)(state.pc + (int8_t)param);
+
+                    if (target <= cmdPc && target < mFirstTick.size() && mFirstTick[target] != SEQ_INDEX_NO_LOOP) {
+                        mLooped = true;
+                        mLoopStartTick = mFirstTick[target];
+                    }
+                }
+
+                int32_t delay = HandleFlowControl(state, cmd, param);
+
+                if (delay == -2)
+                    return false;
+
+                if (delay == -1) {
+                    mSeqFinished = true;
+                    return true;
+                }
+
+                if (delay != 0) {
+                    mSeqDelay = delay;
+                    return true;
+                }
+
+                continue;
+            }
+
+            if (cmd >= 0xC0) {
+                uint8_t u8;
+                uint16_t u16;
+
+                switch (cmd) {
+                    case 0xF1: // reservenotes
+                    case 0xD9: // volscale
+                    case 0xD5: // mutescale
+                    case 0xD3: // mutebhv
+                    case 0xD0: // noteallocpolicy
+                    case 0xDB: // volume
+                    case 0xDC: // tempochg
+                        if (!ReadU8(state, u8))
+                            return false;
+                        break;
+                    case 0xF0: // unreservenotes
+                    case 0xD4: // mute
+                        break;
+                    case 0xDF: // transpose
+                        if (!ReadU8(state, u8))
+                            return false;
+
+                        mTransposition = (int8_t)u8;
+                        break;
+                    case 0xDE: // transposerel
+                        if (!ReadU8(state, u8))
+                            return false;
+
+                        mTransposition += (int8_t)u8;
+                        break;
+                    case 0xDD: // tempo
+                        if (!ReadU8(state, mTempo))
+                            return false;
+                        break;
+                    case 0xDA: // change volume
+                        if (!ReadU8(state, u8) || !ReadU16(state, u16))
+                            return false;
+                        break;
+                    case 0xD7: // initchan
+                    case 0xD6: // disablechan
+                    case 0xD2: // shortnotevelocitytable
+                    case 0xD1: // shortnotegatetimetable
+                    case 0xC5: // scriptctr
+                        if (!ReadU16(state, u16))
+                            return false;
+                        break;
+                    case 0xCC: // ldi
+                        if (!ReadU8(state, u8))
+                            return false;
+
+                        state.value = (int8_t)u8;
+                        break;
+                    case 0xC9: // and
+                        if (!ReadU8(state, u8))
+                            return false;
+
+                        state.value &= (int8_t)u8;
+                        break;
+                    case 0xC8: // sub
+                        if (!ReadU8(state, u8))
+                            return false;
+
+                        state.value -= (int8_t)u8;
+                        break;
+                    case 0xC7: // stseq
+                        if (!ReadU8(state, u8) || !ReadU16(state, u16) || !InRange(u16, 1))
+                            return false;
+
+                        mData[u16] = (uint8_t)(state.value + u8);
+                        break;
+                    case 0xEF:
+                        if (!ReadU16(state, u16) || !ReadU8(state, u8))
+                            return false;
+                        break;
+                    case 0xC6: // stop
+                        mSeqFinished = true;
+                        return true;
+                    default:
+                        return false;
+                }
+
+                continue;
+            }
+
+            uint8_t low = cmd & 0xF;
+            uint8_t u8;
+            uint16_t u16;
+
+            switch (cmd & 0xF0) {
+                case 0x00: // testchan
+                    state.value = mChannels[low].enabled ? 0 : 1;
+                    break;
+                case 0x40: // stopchan
+                    DisableChannel(mChannels[low]);
+                    break;
+                case 0x50: // subio
+                    state.value -= mSoundScriptIO[low & 7];
+                    break;
+                case 0x60: // ldres
+                    if (!ReadU8(state, u8) || !ReadU8(state, u8))
+                        return false;
+                    break;
+                case 0x70: // stio
+                    mSoundScriptIO[low & 7] = state.value;
+                    break;
+                case 0x80: // ldio
+                    state.value = mSoundScriptIO[low & 7];
+
+                    if ((low & 7) < 2)
+                        mSoundScriptIO[low & 7] = -1;
+                    break;
+                case 0x90: // ldchan
+                    if (!ReadU16(state, u16))
+                        return false;
+
+                    EnableChannel(low, u16);
+                    break;
+                case 0xA0: // rldchan
+                    if (!ReadU16(state, u16))
+                        return false;
+
+                    EnableChannel(low, (uint16_t)(state.pc + (int16_t)u16));
+                    break;
+                case 0xB0: // ldseq
+                    if (!ReadU8(state, u8) || !ReadU16(state, u16))
+                        return false;
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool StepChannel(ChannelState& channel) {
+        if (!channel.stopScript) {
+            channel.delay--;
+
+            if (channel.delay <= 0 && !RunChannelScript(channel))
+                return false;
+        }
+
+        if (!channel.enabled)
+            return true;
+
+        for (auto& layer : channel.layers) {
+            if (layer.enabled && !StepLayer(channel, layer))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool RunChannelScript(ChannelState& channel) {
+        ScriptState& state = channel.script;
+
+        for (int i = 0; i < kMaxCommandsPerStep; i++) {
+            uint8_t cmd;
+
+            if (!ReadU8(state, cmd))
+                return false;
+
+            if (cmd >= 0xB0) {
+                uint16_t params[3] = {};
+
+                if (cmd < 0xF2) {
+                    const uint8_t* args = sChannelArgs[cmd - 0xB0];
+
+                    if (args[0] == NA)
+                        return false;
+
+                    for (int k = 0; k < 3 && args[k] != 0; k++) {
+                        if (args[k] == 1) {
+                            uint8_t u8;
+
+                            if (!ReadU8(state, u8))
+                                return false;
+
+                            params[k] = u8;
+                        } else if (!ReadU16(state, params[k])) {
+                            return false;
+                        }
+                    }
+                } else {
+                    if (!ReadFlowParam(state, cmd, params[0]))
+                        return false;
+
+                    int32_t delay = HandleFlowControl(state, cmd, params[0]);
+
+                    if (delay == -2)
+                        return false;
+
+                    if (delay == -1) {
+                        DisableChannel(channel);
+                        return true;
+                    }
+
+                    if (delay != 0) {
+                        channel.delay = delay;
+                        return true;
+                    }
+
+                    continue;
+                }
+
+                switch (cmd) {
+                    case 0xEA: // stop script
+                        channel.stopScript = true;
+                        return true;
+                    case 0xC1: // set instrument
+                        channel.instrument = (uint8_t)params[0];
+                        break;
+                    case 0xC6: // set soundfont
+                        channel.fontId = (uint8_t)params[0];
+                        break;
+                    case 0xEB: // set soundfont and instrument
+                        channel.fontId = (uint8_t)params[0];
+                        channel.instrument = (uint8_t)params[1];
+                        break;
+                    case 0xDF: // volume
+                        channel.volume = (uint8_t)params[0];
+                        break;
+                    case 0xDD: // pan
+                        channel.pan = (uint8_t)params[0];
+                        break;
+                    case 0xDB: // transpose
+                        channel.transposition = (int8_t)params[0];
+                        break;
+                    case 0xC3: // large notes off
+                        channel.largeNotes = false;
+                        break;
+                    case 0xC4: // large notes on
+                        channel.largeNotes = true;
+                        break;
+                    case 0xC2: // set dyntable
+                        channel.dynTable = params[0];
+                        break;
+                    case 0xC5: { // dyn set dyntable
+                        if (state.value != -1) {
+                            uint16_t addr;
+
+                            if (state.value < 0 || !PeekU16(channel.dynTable + state.value * 2, addr))
+                                return false;
+
+                            channel.dynTable = addr;
+                        }
+                        break;
+                    }
+                    case 0xB4: // set dyntable large
+                        channel.dynTable = channel.largeValue;
+                        break;
+                    case 0xB5: // read dyntable large
+                        if (state.value < 0 || !PeekU16(channel.dynTable + state.value * 2, channel.largeValue))
+                            return false;
+                        break;
+                    case 0xB6: // read dyntable
+                        if (state.value < 0 || !InRange(channel.dynTable + state.value, 1))
+                            return false;
+
+                        state.value = (int8_t)mData[channel.dynTable + state.value];
+                        break;
+                    case 0xB2: // dynread sequence large
+                        if (state.value < 0 || !PeekU16(params[0] + state.value * 2, channel.largeValue))
+                            return false;
+                        break;
+                    case 0xB7: // random range large
+                        channel.largeValue = 0;
+                        break;
+                    case 0xB8: // random value
+                        state.value = 0;
+                        break;
+                    case 0xBC: // add large
+                        channel.largeValue += params[0];
+                        break;
+                    case 0xCE: // set large value
+                        channel.largeValue = params[0];
+                        break;
+                    case 0xE4: { // dyncall
+                        if (state.value != -1) {
+                            uint16_t addr;
+
+                            if (state.value < 0 || state.depth >= 4 ||
+                                !PeekU16(channel.dynTable + state.value * 2, addr))
+                                return false;
+
+                            state.stack[state.depth++] = state.pc;
+                            state.pc = addr;
+                        }
+                        break;
+                    }
+                    case 0xC7: // write into sequence
+                        if (!InRange(params[1], 1))
+                            return false;
+
+                        mData[params[1]] = (uint8_t)(state.value + params[0]);
+                        break;
+                    case 0xCF: // write large into sequence
+                        if (!InRange(params[0], 2))
+                            return false;
+
+                        mData[params[0]] = (uint8_t)(channel.largeValue >> 8);
+                        mData[params[0] + 1] = (uint8_t)(channel.largeValue & 0xFF);
+                        break;
+                    case 0xC8: // subtract
+                        state.value -= (int8_t)params[0];
+                        break;
+                    case 0xC9: // bit and
+                        state.value &= (int8_t)params[0];
+                        break;
+                    case 0xCC: // set value
+                        state.value = (int8_t)params[0];
+                        break;
+                    case 0xCB: // read sequence
+                        if (!InRange(params[0] + (uint8_t)state.value, 1))
+                            return false;
+
+                        state.value = (int8_t)mData[params[0] + (uint8_t)state.value];
+                        break;
+                    case 0xCD: // disable channel
+                        DisableChannel(mChannels[params[0] & 0xF]);
+
+                        if (!channel.enabled)
+                            return true;
+                        break;
+                    case 0xE8: { // set channel parameters
+                        uint8_t u8;
+
+                        for (int k = 0; k < 8; k++) {
+                            if (!ReadU8(state, u8))
+                                return false;
+
+                            if (k == 3)
+                                channel.transposition = (int8_t)u8;
+                            else if (k == 4)
+                                channel.pan = u8;
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+
+                continue;
+            }
+
+            if (cmd >= 0x70) {
+                uint8_t low = cmd & 7;
+                uint16_t u16;
+
+                if ((cmd & 0xF8) != 0x70 && low >= 4)
+                    return false;
+
+                switch (cmd & 0xF8) {
+                    case 0x70: // stio
+                        channel.soundScriptIO[low] = state.value;
+                        break;
+                    case 0x78: // rldlayer
+                        if (!ReadU16(state, u16))
+                            return false;
+
+                        SetLayer(channel.layers[low & 3], (uint16_t)(state.pc + (int16_t)u16));
+                        break;
+                    case 0x80: // testlayer
+                        state.value = channel.layers[low].allocated ? channel.layers[low].finished : -1;
+                        break;
+                    case 0x88: // ldlayer
+                        if (!ReadU16(state, u16))
+                            return false;
+
+                        SetLayer(channel.layers[low], u16);
+                        break;
+                    case 0x90: // dellayer
+                        channel.layers[low] = LayerState();
+                        break;
+                    case 0x98: // dynldlayer
+                        if (state.value != -1) {
+                            if (state.value < 0 || !PeekU16(channel.dynTable + state.value * 2, u16))
+                                return false;
+
+                            SetLayer(channel.layers[low], u16);
+                        }
+                        break;
+                    default:
+                        return false;
+                }
+
+                continue;
+            }
+
+            uint8_t low = cmd & 0xF;
+            uint8_t u8;
+            uint16_t u16;
+
+            switch (cmd & 0xF0) {
+                case 0x00: // cdelay
+                    channel.delay = low;
+                    return true;
+                case 0x10: // sample load
+                    // The load sets channel IO [low & 7] to -1 and reports completion in it asynchronously
+                    return false;
+                case 0x20: // startchannel
+                    if (!ReadU16(state, u16))
+                        return false;
+
+                    EnableChannel(low, u16);
+
+                    if (!channel.enabled)
+                        return true;
+                    break;
+                case 0x30: // stcio
+                    if (!ReadU8(state, u8))
+                        return false;
+
+                    mChannels[low].soundScriptIO[u8 & 7] = state.value;
+                    break;
+                case 0x40: // ldcio
+                    if (!ReadU8(state, u8))
+                        return false;
+
+                    state.value = mChannels[low].soundScriptIO[u8 & 7];
+                    break;
+                case 0x50: // subio
+                    state.value -= channel.soundScriptIO[low & 7];
+                    break;
+                case 0x60: // ldio
+                    state.value = channel.soundScriptIO[low & 7];
+
+                    if ((low & 7) < 2)
+                        channel.soundScriptIO[low & 7] = -1;
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        return false;
+    }
+
+    void SetLayer(LayerState& layer, uint16_t pc) {
+        layer = LayerState();
+        layer.allocated = true;
+        layer.enabled = true;
+        layer.script.pc = pc;
+    }
+
+    bool StepLayer(ChannelState& channel, LayerState& layer) {
+        if (layer.delay > 1) {
+            layer.delay--;
+            return true;
+        }
+
+        ScriptState& state = layer.script;
+
+        for (int i = 0; i < kMaxCommandsPerStep; i++) {
+            uint8_t cmd;
+            uint8_t u8;
+            uint16_t u16;
+
+            if (!ReadU8(state, cmd))
+                return false;
+
+            if (cmd >= 0xF2) {
+                if (!ReadFlowParam(state, cmd, u16))
+                    return false;
+
+                int32_t delay = HandleFlowControl(state, cmd, u16);
+
+                if (delay == -2)
+                    return false;
+
+                if (delay == -1) {
+                    layer.enabled = false;
+                    layer.finished = true;
+                    return true;
+                }
+
+                if (delay != 0) {
+                    layer.delay = delay;
+                    return true;
+                }
+
+                continue;
+            }
+
+            if (cmd < 0xC0)
+                return RunLayerNote(channel, layer, cmd);
+
+            switch (cmd) {
+                case 0xC0: // ldelay
+                    if (!ReadCompressedU16(state, u16))
+                        return false;
+
+                    layer.delay = u16;
+                    return true;
+                case 0xC1: // short note velocity
+                case 0xC9: // short note gate time
+                case 0xCA: // pan
+                case 0xCD: // reverb bits
+                case 0xCE: // bend pitch
+                case 0xCF: // release rate
+                    if (!ReadU8(state, u8))
+                        return false;
+                    break;
+                case 0xC2: // transpose
+                    if (!ReadU8(state, u8))
+                        return false;
+
+                    layer.transposition = (int8_t)u8;
+                    break;
+                case 0xC3: // short note default play percentage
+                    if (!ReadCompressedU16(state, layer.shortNoteDefaultPlayPercentage))
+                        return false;
+                    break;
+                case 0xC4: // legato on
+                case 0xC5: // legato off
+                case 0xC8: // portamento off
+                case 0xCC: // ignore drum pan
+                    break;
+                case 0xC6: // instrument
+                    if (!ReadU8(state, layer.instrument))
+                        return false;
+                    break;
+                case 0xC7: { // portamento
+                    uint8_t mode;
+
+                    if (!ReadU8(state, mode) || !ReadU8(state, u8))
+                        return false;
+
+                    if ((mode & 0x80) ? !ReadU8(state, u8) : !ReadCompressedU16(state, u16))
+                        return false;
+                    break;
+                }
+                case 0xCB: // envelope
+                    if (!ReadU16(state, u16) || !ReadU8(state, u8))
+                        return false;
+                    break;
+                default:
+                    // 0xD0-0xEF select short note velocity and gate time table entries.
+                    if (cmd >= 0xD0 && cmd < 0xF0)
+                        break;
+
+                    return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool RunLayerNote(ChannelState& channel, LayerState& layer, uint8_t cmd) {
+        ScriptState& state = layer.script;
+        uint16_t delay = 0;
+        uint8_t u8;
+
+        if (channel.largeNotes) {
+            switch (cmd & 0xC0) {
+                case 0x00: // note0: delay, velocity, gate time
+                    if (!ReadCompressedU16(state, delay) || !ReadU8(state, u8) || !ReadU8(state, u8))
+                        return false;
+
+                    layer.lastDelay = delay;
+                    break;
+                case 0x40: // note1: delay, velocity
+                    if (!ReadCompressedU16(state, delay) || !ReadU8(state, u8))
+                        return false;
+
+                    layer.lastDelay = delay;
+                    break;
+                case 0x80: // note2: velocity, gate time
+                    if (!ReadU8(state, u8) || !ReadU8(state, u8))
+                        return false;
+
+                    delay = layer.lastDelay;
+                    break;
+            }
+        } else {
+            switch (cmd & 0xC0) {
+                case 0x00:
+                    if (!ReadCompressedU16(state, delay))
+                        return false;
+
+                    layer.lastDelay = delay;
+                    break;
+                case 0x40:
+                    delay = layer.shortNoteDefaultPlayPercentage;
+                    break;
+                case 0x80:
+                    delay = layer.lastDelay;
+                    break;
+            }
+        }
+
+        layer.delay = delay;
+        return true;
+    }
+
+    static SeqScriptCheckpoint CaptureScript(const ScriptState& state) {
+        SeqScriptCheckpoint script;
+
+        script.pc = state.pc;
+        script.depth = state.depth;
+        script.value = state.value;
+
+        for (int i = 0; i < 4; i++) {
+            script.stack[i] = state.stack[i];
+            script.remLoopIters[i] = state.remLoopIters[i];
+        }
+
+        return script;
+    }
+
+    SeqCheckpoint Capture(uint32_t tick) const {
+        SeqCheckpoint checkpoint;
+
+        checkpoint.tick = tick;
+        checkpoint.script = CaptureScript(mSeqScript);
+        checkpoint.delay = (uint16_t)mSeqDelay;
+        checkpoint.tempo = mTempo;
+        checkpoint.transposition = mTransposition;
+
+        for (int i = 0; i < 8; i++)
+            checkpoint.soundScriptIO[i] = mSoundScriptIO[i];
+
+        for (uint8_t c = 0; c < 16; c++) {
+            const ChannelState& channel = mChannels[c];
+
+            if (!channel.enabled)
+                continue;
+
+            SeqChannelCheckpoint ch;
+
+            ch.index = c;
+            ch.stopScript = channel.stopScript;
+            ch.largeNotes = channel.largeNotes;
+            ch.script = CaptureScript(channel.script);
+            ch.delay = (uint16_t)(channel.delay < 0 ? 0 : channel.delay);
+            ch.dynTable = channel.dynTable;
+            ch.fontId = channel.fontId;
+            ch.instrument = channel.instrument;
+            ch.volume = channel.volume;
+            ch.pan = channel.pan;
+            ch.transposition = channel.transposition;
+
+            for (int i = 0; i < 8; i++)
+                ch.soundScriptIO[i] = channel.soundScriptIO[i];
+
+            for (uint8_t l = 0; l < 4; l++) {
+                const LayerState& layer = channel.layers[l];
+
+                if (!layer.enabled)
+                    continue;
+
+                SeqLayerCheckpoint ly;
+
+                ly.index = l;
+                ly.script = CaptureScript(layer.script);
+                ly.delay = (uint16_t)layer.delay;
+                ly.lastDelay = layer.lastDelay;
+                ly.shortNoteDefaultPlayPercentage = layer.shortNoteDefaultPlayPercentage;
+                ly.instrument = layer.instrument;
+                ly.transposition = layer.transposition;
+                ch.layers.push_back(ly);
+            }
+
+            checkpoint.channels.push_back(ch);
+        }
+
+        return checkpoint;
+    }
+
+    std::vector<uint8_t> mData;
+    std::vector<uint32_t> mFirstTick;
+
+    ScriptState mSeqScript;
+    int32_t mSeqDelay = 0;
+    bool mSeqFinished = false;
+    uint8_t mTempo = 0;
+    int8_t mTransposition = 0;
+    int8_t mSoundScriptIO[8];
+    ChannelState mChannels[16];
+
+    bool mLooped = false;
+    uint32_t mLoopStartTick = SEQ_INDEX_NO_LOOP;
+};
+
+} // namespace
+
+bool BuildSequenceIndex(const std::vector<char>& seqData, uint32_t interval, SeqIndex& index) {
+    if (interval == 0 || seqData.empty())
+        return false;
+
+    SequenceWalker walker(seqData);
+
+    return walker.Run(interval, index);
+}
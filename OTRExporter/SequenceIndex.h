@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Seek index for audio sequences.
+//
+// The exporter runs the sequence, channel and layer scripts of a sequence without producing any sound and
+// records the interpreter state every `interval` ticks. The runtime can then restore the nearest checkpoint
+// and resume playback from there instead of fast-forwarding the whole script.
+//
+// The walk assumes the default playback path: no IO ports are written by the game and random commands
+// return 0. Sequences using commands that cannot be followed statically do not get an index.
+
+#define SEQ_INDEX_NO_LOOP 0xFFFFFFFF
+
+struct SeqScriptCheckpoint {
+    uint16_t pc = 0;
+    uint16_t stack[4] = {};
+    uint8_t remLoopIters[4] = {};
+    uint8_t depth = 0;
+    int8_t value = 0;
+};
+
+struct SeqLayerCheckpoint {
+    uint8_t index = 0;
+    SeqScriptCheckpoint script;
+    uint16_t delay = 0;
+    uint16_t lastDelay = 0;
+    uint16_t shortNoteDefaultPlayPercentage = 0;
+    uint8_t instrument = 0;
+    int8_t transposition = 0;
+};
+
+struct SeqChannelCheckpoint {
+    uint8_t index = 0;
+    bool stopScript = false;
+    bool largeNotes = false;
+    SeqScriptCheckpoint script;
+    uint16_t delay = 0;
+    uint16_t dynTable = 0;
+    uint8_t fontId = 0xFF;
+    uint8_t instrument = 0;
+    uint8_t volume = 0;
+    uint8_t pan = 0;
+    int8_t transposition = 0;
+    int8_t soundScriptIO[8] = {};
+    std::vector<SeqLayerCheckpoint> layers;
+};
+
+struct SeqCheckpoint {
+    uint32_t tick = 0;
+    SeqScriptCheckpoint script;
+    uint16_t delay = 0;
+    uint8_t tempo = 0;
+    int8_t transposition = 0;
+    int8_t soundScriptIO[8] = {};
+    std::vector<SeqChannelCheckpoint> channels;
+};
+
+struct SeqIndex {
+    uint32_t interval = 0;
+    uint32_t loopStartTick = SEQ_INDEX_NO_LOOP;
+    uint32_t loopEndTick = SEQ_INDEX_NO_LOOP;
+    std::vector<SeqCheckpoint> checkpoints;
+};
+
+// Returns false if the sequence could not be walked, in which case no index should be written.
+bool BuildSequenceIndex(const std::vector<char>& seqData, uint32_t interval, SeqIndex& index);
@@ -2,12 +2,60 @@
 #include <libultraship/bridge.h>
 #include <Globals.h>
 #include "DisplayListExporter.h"
+#include "SkeletonLimbExporter.h"
+#include "Dependencies.h"
+#include "Main.h"
+#include "PathHash.h"
+#undef FindResource
+
+// Resolves every limb of the skeleton. Fails for skin limbs, for legacy limbs (which link to their child and sibling
+// by pointer rather than by index) and for limbs that cannot be found, in which case the skeleton is written in the
+// version 0 layout.
+static bool GetInlineLimbs(ZSkeleton* skel, std::vector<ZLimb*>& limbs)
+{
+	if (skel->limbType == ZLimbType::Skin || skel->limbType == ZLimbType::Legacy)
+		return false;
+
+	for (size_t i = 0; i < skel->limbsTable->count; i++)
+	{
+		segptr_t limbAddress = skel->limbsTable->limbsAddresses[i];
+		ZFile* limbFile = Globals::Instance->GetSegment(GETSEGNUM(limbAddress), skel->parent->workerID);
+
+		if (limbFile == nullptr)
+			return false;
+
+		ZResource* limbRes = limbFile->FindResource(GETSEGOFFSET(limbAddress));
+
+		if (limbRes == nullptr || limbRes->GetResourceType() != ZResourceType::Limb)
+			return false;
+
+		ZLimb* limb = (ZLimb*)limbRes;
+
+		if (limb->type == ZLimbType::Skin || limb->type == ZLimbType::Legacy)
+			return false;
+
+		limbs.push_back(limb);
+	}
+
+	return true;
+}
+
+static uint64_t GetLimbDListHash(ZSkeleton* skel, ZLimb* limb, segptr_t dListPtr)
+{
+	std::string path = OTRExporter_SkeletonLimb::GetLimbDListPath(limb, dListPtr);
+
+	AddDependency(skel, path);
+	return HashPath(path);
+}
 
 void OTRExporter_Skeleton::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZSkeleton* skel = (ZSkeleton*)res;
 
-	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Skeleton));
+	std::vector<ZLimb*> limbs;
+	bool writeInline = inlineLimbs && GetInlineLimbs(skel, limbs);
+
+	WriteHeader(res, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Skeleton), writeInline ? SKELETON_INLINE_LIMBS_VERSION : 0);
 
 	writer->Write((uint8_t)skel->type);
 	writer->Write((uint8_t)skel->limbType);
@@ -18,6 +66,33 @@ void OTRExporter_Skeleton::Save(ZResource* res, const fs::path& outPath, BinaryW
 	writer->Write((uint8_t)skel->limbsTable->limbType);
 	writer->Write((uint32_t)skel->limbsTable->count);
 
+	if (writeInline)
+	{
+		for (ZLimb* limb : limbs)
+		{
+			writer->Write((uint8_t)limb->type);
+
+			writer->Write(limb->legTransX);
+			writer->Write(limb->legTransY);
+			writer->Write(limb->legTransZ);
+			writer->Write(limb->rotX);
+			writer->Write(limb->rotY);
+			writer->Write(limb->rotZ);
+
+			writer->Write(GetLimbDListHash(skel, limb, limb->dListPtr));
+			writer->Write(GetLimbDListHash(skel, limb, limb->dList2Ptr));
+
+			writer->Write(limb->transX);
+			writer->Write(limb->transY);
+			writer->Write(limb->transZ);
+
+			writer->Write(limb->childIndex);
+			writer->Write(limb->siblingIndex);
+		}
+
+		return;
+	}
+
 	for (size_t i = 0; i < skel->limbsTable->count; i++)
 	{
 		Declaration* skelDecl = skel->parent->GetDeclarationRanged(GETSEGOFFSET(skel->limbsTable->limbsAddresses[i]));
@@ -29,11 +104,11 @@ void OTRExporter_Skeleton::Save(ZResource* res, const fs::path& outPath, BinaryW
 			if (name.at(0) == '&')
 				name.erase(0, 1);
 
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(res, name));
+			WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(res, name));
 		}
 		else
 		{
-			writer->Write("");
+			WritePath(res, writer, "");
 		}
 	}
 }
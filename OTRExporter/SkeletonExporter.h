@@ -7,6 +7,11 @@
 #include "Exporter.h"
 #include <Utils/BinaryWriter.h>
 
+// Version 1 of skeleton resources embeds every limb instead of referencing limb entries by path.
+// Limbs link to each other by index and display lists are stored as 64 bit path hashes, so the
+// whole skeleton is read with a single archive lookup. Skin skeletons keep the version 0 layout.
+#define SKELETON_INLINE_LIMBS_VERSION 1
+
 class OTRExporter_Skeleton : public OTRExporter
 {
 public:
@@ -3,6 +3,24 @@
 #include <libultraship/bridge.h>
 #include <Globals.h>
 
+std::string OTRExporter_SkeletonLimb::GetLimbDListPath(ZLimb* limb, segptr_t dListPtr)
+{
+	if (dListPtr == 0)
+		return "";
+
+	std::string name;
+	bool foundDecl = Globals::Instance->GetSegmentedPtrName(dListPtr, limb->parent, "", name, limb->parent->workerID);
+	if (!foundDecl)
+		return "";
+
+	if (name.at(0) == '&')
+		name.erase(0, 1);
+
+	ZFile* assocFile = Globals::Instance->GetSegment(GETSEGNUM(dListPtr), limb->parent->workerID);
+
+	return OTRExporter_DisplayList::GetPathToRes(assocFile->resources[0], name);
+}
+
 void OTRExporter_SkeletonLimb::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZLimb* limb = (ZLimb*)res;
@@ -17,13 +35,13 @@ void OTRExporter_SkeletonLimb::Save(ZResource* res, const fs::path& outPath, Bin
 		auto childDecl = limb->parent->GetDeclaration(GETSEGOFFSET(limb->skinSegment));
 
 		if (childDecl != nullptr)
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(limb, childDecl->declName));
+			WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(limb, childDecl->declName));
 		else
-			writer->Write("");
+			WritePath(res, writer, "");
 	}
 	else
 	{
-		writer->Write("");
+		WritePath(res, writer, "");
 	}
 
 	writer->Write((uint16_t)limb->segmentStruct.totalVtxCount);
@@ -64,16 +82,16 @@ void OTRExporter_SkeletonLimb::Save(ZResource* res, const fs::path& outPath, Bin
 
 		if (skinGfxDecl != nullptr)
 		{
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(limb, skinGfxDecl->declName));
+			WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(limb, skinGfxDecl->declName));
 		}
 		else
 		{
-			writer->Write("");
+			WritePath(res, writer, "");
 		}
 	}
 	else
 	{
-		writer->Write("");
+		WritePath(res, writer, "");
 	}
 
 	writer->Write(limb->legTransX);
@@ -92,16 +110,16 @@ void OTRExporter_SkeletonLimb::Save(ZResource* res, const fs::path& outPath, Bin
 			if (name.at(0) == '&')
 				name.erase(0, 1);
 
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(limb, name));
+			WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(limb, name));
 		}
 		else
 		{
-			writer->Write("");
+			WritePath(res, writer, "");
 		}
 	}
 	else
 	{
-		writer->Write("");
+		WritePath(res, writer, "");
 	}
 
 	if (limb->siblingPtr != 0)
@@ -113,63 +131,31 @@ void OTRExporter_SkeletonLimb::Save(ZResource* res, const fs::path& outPath, Bin
 			if (name.at(0) == '&')
 				name.erase(0, 1);
 
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(limb, name));
+			WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(limb, name));
 		}
 		else
 		{
-			writer->Write("");
+			WritePath(res, writer, "");
 		}
 	}
 	else
 	{
-		writer->Write("");
+		WritePath(res, writer, "");
 	}
 
-	if (limb->dListPtr != 0)
-	{
-		std::string name;
-		bool foundDecl = Globals::Instance->GetSegmentedPtrName(limb->dListPtr, limb->parent, "", name, res->parent->workerID);
-		if (foundDecl)
-		{
-			if (name.at(0) == '&')
-				name.erase(0, 1);
-
-			ZFile* assocFile = Globals::Instance->GetSegment(GETSEGNUM(limb->dListPtr), res->parent->workerID);
+	std::string dListPath = GetLimbDListPath(limb, limb->dListPtr);
 
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(assocFile->resources[0], name));
-		}
-		else
-		{
-			writer->Write("");
-		}
-	}
+	if (!dListPath.empty())
+		WritePath(res, writer, dListPath);
 	else
-	{
-		writer->Write("");
-	}
+		WritePath(res, writer, "");
 
-	if (limb->dList2Ptr != 0)
-	{
-		std::string name;
-		bool foundDecl = Globals::Instance->GetSegmentedPtrName(limb->dList2Ptr, limb->parent, "", name, res->parent->workerID);
-		if (foundDecl)
-		{
-			if (name.at(0) == '&')
-				name.erase(0, 1);
+	std::string dList2Path = GetLimbDListPath(limb, limb->dList2Ptr);
 
-			ZFile* assocFile = Globals::Instance->GetSegment(GETSEGNUM(limb->dList2Ptr), res->parent->workerID);
-
-			writer->Write(OTRExporter_DisplayList::GetPathToRes(assocFile->resources[0], name));
-		}
-		else
-		{
-			writer->Write("");
-		}
-	}
+	if (!dList2Path.empty())
+		WritePath(res, writer, dList2Path);
 	else
-	{
-		writer->Write("");
-	}
+		WritePath(res, writer, "");
 
 	writer->Write(limb->transX);
 	writer->Write(limb->transY);
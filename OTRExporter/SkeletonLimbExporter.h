@@ -11,5 +11,7 @@
 class OTRExporter_SkeletonLimb : public OTRExporter
 {
 public:
+	// Resolves a limb display list pointer to its archive path, or an empty string if it has none
+	static std::string GetLimbDListPath(ZLimb* limb, segptr_t dListPtr);
 	virtual void Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer) override;
 };
\ No newline at end of file
@@ -1,14 +1,39 @@
 #include "TextExporter.h"
 #include "../ZAPD/ZFile.h"
+#include "MessageTable.h"
+#include "Main.h"
 
 void OTRExporter_Text::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZText* txt = (ZText*)res;
 
-	WriteHeader(txt, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Text));
+	bool writeTable = textTable;
+
+	WriteHeader(txt, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::SOH_Text), writeTable ? TEXT_MESSAGE_TABLE_VERSION : 0);
 
 	writer->Write((uint32_t)txt->messages.size());
 
+	if (writeTable)
+	{
+		MessageTableLayout table = BuildMessageTable(txt->messages, textIntern);
+
+		// 12 byte entries: id, box type, box position, string offset and length
+		for (size_t i = 0; i < table.order.size(); i++)
+		{
+			const auto& message = txt->messages[table.order[i]];
+
+			writer->Write((uint16_t)message.id);
+			writer->Write((uint8_t)message.textboxType);
+			writer->Write((uint8_t)message.textboxYPos);
+			writer->Write(table.strings[i].offset);
+			writer->Write(table.strings[i].length);
+		}
+
+		writer->Write((uint32_t)table.blob.size());
+		WriteArray(writer, table.blob);
+		return;
+	}
+
 	for (size_t i = 0; i < txt->messages.size(); i++)
 	{
 		writer->Write(txt->messages[i].id);
@@ -1,15 +1,47 @@
 #ifdef GAME_MM
 #include "TextMMExporter.h"
 #include "../ZAPD/ZFile.h"
+#include "MessageTable.h"
+#include "Main.h"
 
 void OTRExporter_TextMM::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZTextMM* txt = (ZTextMM*)res;
 
-	WriteHeader(txt, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::TSH_TextMM));
+	bool writeTable = textTable;
+
+	WriteHeader(txt, outPath, writer, static_cast<uint32_t>(SOH::ResourceType::TSH_TextMM), writeTable ? TEXT_MESSAGE_TABLE_VERSION : 0);
 
 	writer->Write((uint32_t)txt->messages.size());
 
+	if (writeTable)
+	{
+		MessageTableLayout table = BuildMessageTable(txt->messages, textIntern);
+
+		// 20 byte entries: id, box type, box position, icon, padding, next message id, both item costs, padding,
+		// string offset and length
+		for (size_t i = 0; i < table.order.size(); i++)
+		{
+			const auto& message = txt->messages[table.order[i]];
+
+			writer->Write((uint16_t)message.id);
+			writer->Write((uint8_t)message.textboxType);
+			writer->Write((uint8_t)message.textboxYPos);
+			writer->Write((uint8_t)message.icon);
+			writer->Write((uint8_t)0);
+			writer->Write((uint16_t)message.nextMessageID);
+			writer->Write((int16_t)message.firstItemCost);
+			writer->Write((int16_t)message.secondItemCost);
+			writer->Write((uint16_t)0);
+			writer->Write(table.strings[i].offset);
+			writer->Write(table.strings[i].length);
+		}
+
+		writer->Write((uint32_t)table.blob.size());
+		WriteArray(writer, table.blob);
+		return;
+	}
+
 	for (size_t i = 0; i < txt->messages.size(); i++)
 	{
 		writer->Write(txt->messages[i].id);
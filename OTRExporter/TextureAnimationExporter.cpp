@@ -103,12 +103,12 @@ void OTRExporter_TextureAnimation::Save(ZResource* res, const fs::path& outPath,
 						if (name.at(0) == '&')
 							name.erase(0, 1);
 
-						writer->Write(OTRExporter_DisplayList::GetPathToRes(res, name));
+						WritePath(res, writer, OTRExporter_DisplayList::GetPathToRes(res, name));
 					}
 					else
 					{
 						spdlog::error("Texture not found: 0x{:X}", t);
-						writer->Write("");
+						WritePath(res, writer, "");
 					}
 				}
 				for (const auto index : cycleParams->textureIndexList) {
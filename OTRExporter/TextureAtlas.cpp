@@ -0,0 +1,186 @@
+#include "TextureAtlas.h"
+#include "PathHash.h"
+#include "Main.h"
+#include <Utils/MemoryStream.h>
+#include <Utils/BinaryWriter.h>
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+struct AtlasTexture {
+    std::string path;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> rgba;
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+static std::mutex atlasMutex;
+static std::map<std::string, std::vector<AtlasTexture>> atlasTextures;
+
+std::string GetTextureAtlasGroup(const std::string& path)
+{
+    for (const auto& group : atlasGroups) {
+        if (path.starts_with(group))
+            return group;
+    }
+
+    return "";
+}
+
+void AddAtlasTexture(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba)
+{
+    std::string group = GetTextureAtlasGroup(path);
+
+    if (group == "" || width == 0 || height == 0 || width > TEXTURE_ATLAS_MAX_TEXTURE_SIZE ||
+        height > TEXTURE_ATLAS_MAX_TEXTURE_SIZE)
+        return;
+
+    std::unique_lock Lock(atlasMutex);
+    atlasTextures[group].push_back({ path, width, height, rgba });
+}
+
+// Shelf packing: textures sorted by height are placed left to right in rows of the given width. Returns the used
+// height, or 0 if the textures do not fit.
+static uint32_t PackShelves(std::vector<AtlasTexture>& textures, uint32_t atlasWidth)
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t shelfHeight = 0;
+
+    for (auto& tex : textures) {
+        uint32_t w = tex.width + TEXTURE_ATLAS_PADDING * 2;
+        uint32_t h = tex.height + TEXTURE_ATLAS_PADDING * 2;
+
+        if (w > atlasWidth)
+            return 0;
+
+        if (x + w > atlasWidth) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        tex.x = x + TEXTURE_ATLAS_PADDING;
+        tex.y = y + TEXTURE_ATLAS_PADDING;
+
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+
+    return y + shelfHeight;
+}
+
+static TextureAtlas BuildAtlas(std::vector<AtlasTexture>& textures)
+{
+    // Tallest first for the shelf packer. Equal heights are ordered by path, so the result does not depend on the
+    // order worker threads queued the textures in.
+    std::sort(textures.begin(), textures.end(), [](const AtlasTexture& a, const AtlasTexture& b) {
+        return a.height != b.height ? a.height > b.height : a.path < b.path;
+    });
+
+    size_t area = 0;
+
+    for (const auto& tex : textures)
+        area += (size_t)(tex.width + TEXTURE_ATLAS_PADDING * 2) * (tex.height + TEXTURE_ATLAS_PADDING * 2);
+
+    TextureAtlas atlas;
+    atlas.width = 16;
+
+    while ((size_t)atlas.width * atlas.width < area)
+        atlas.width *= 2;
+
+    for (; atlas.width <= TEXTURE_ATLAS_MAX_SIZE; atlas.width *= 2) {
+        uint32_t usedHeight = PackShelves(textures, atlas.width);
+
+        if (usedHeight == 0)
+            continue;
+
+        atlas.height = 1;
+
+        while (atlas.height < usedHeight)
+            atlas.height *= 2;
+
+        if (atlas.height <= TEXTURE_ATLAS_MAX_SIZE)
+            break;
+    }
+
+    if (atlas.width > TEXTURE_ATLAS_MAX_SIZE)
+        return TextureAtlas();
+
+    atlas.rgba.resize((size_t)atlas.width * atlas.height * 4);
+
+    for (const auto& tex : textures) {
+        int32_t pad = TEXTURE_ATLAS_PADDING;
+
+        for (int32_t y = -pad; y < (int32_t)tex.height + pad; y++) {
+            for (int32_t x = -pad; x < (int32_t)tex.width + pad; x++) {
+                uint32_t srcX = (uint32_t)std::clamp(x, 0, (int32_t)tex.width - 1);
+                uint32_t srcY = (uint32_t)std::clamp(y, 0, (int32_t)tex.height - 1);
+                size_t dst = ((size_t)(tex.y + y) * atlas.width + tex.x + x) * 4;
+
+                std::copy_n(&tex.rgba[((size_t)srcY * tex.width + srcX) * 4], 4, &atlas.rgba[dst]);
+            }
+        }
+    }
+
+    std::vector<std::pair<uint64_t, const AtlasTexture*>> entries;
+
+    for (const auto& tex : textures)
+        entries.push_back({ HashPath(tex.path), &tex });
+
+    std::sort(entries.begin(), entries.end());
+
+    MemoryStream* rectsStream = new MemoryStream();
+    BinaryWriter rectsWriter = BinaryWriter(rectsStream);
+
+    rectsWriter.Write((uint32_t)TEXTURE_ATLAS_MAGIC);
+    rectsWriter.Write((uint32_t)TEXTURE_ATLAS_VERSION);
+    rectsWriter.Write(atlas.width);
+    rectsWriter.Write(atlas.height);
+    rectsWriter.Write((uint32_t)entries.size());
+
+    for (const auto& entry : entries) {
+        rectsWriter.Write(entry.first);
+        rectsWriter.Write((uint16_t)entry.second->x);
+        rectsWriter.Write((uint16_t)entry.second->y);
+        rectsWriter.Write((uint16_t)entry.second->width);
+        rectsWriter.Write((uint16_t)entry.second->height);
+    }
+
+    atlas.rects = rectsStream->ToVector();
+
+    return atlas;
+}
+
+std::map<std::string, TextureAtlas> PackTextureAtlases()
+{
+    std::unique_lock Lock(atlasMutex);
+    std::map<std::string, TextureAtlas> atlases;
+
+    for (auto& group : atlasTextures) {
+        TextureAtlas atlas = BuildAtlas(group.second);
+
+        if (atlas.width == 0) {
+            printf("Texture atlas %s does not fit in %dx%d, skipping it\n", group.first.c_str(),
+                   TEXTURE_ATLAS_MAX_SIZE, TEXTURE_ATLAS_MAX_SIZE);
+            continue;
+        }
+
+        size_t usedArea = 0;
+
+        for (const auto& tex : group.second)
+            usedArea += (size_t)tex.width * tex.height;
+
+        printf("Packed %zu textures of %s into a %ux%u atlas (%.1f%% used)\n", group.second.size(),
+               group.first.c_str(), atlas.width, atlas.height,
+               100.0 * usedArea / ((size_t)atlas.width * atlas.height));
+
+        atlases.emplace(group.first, std::move(atlas));
+    }
+
+    atlasTextures.clear();
+
+    return atlases;
+}
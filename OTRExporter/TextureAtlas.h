@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Texture atlases pack the small textures of a configured folder (--atlasGroup) into one RGBA32 texture, so HUD
+// and menu rendering can bind a single texture. The source textures are still written; atlases are an addition.
+//
+// Each group gets two entries: "<group>/atlas", a regular texture resource, and "<group>/atlasRects":
+//   u32 magic 'ATLS', u32 version, u32 atlas width, u32 atlas height, u32 entry count
+//   entry table sorted by hash: u64 CRC64 of the source texture path, u16 x, u16 y, u16 width, u16 height
+
+#define TEXTURE_ATLAS_MAGIC 0x41544C53
+#define TEXTURE_ATLAS_VERSION 0
+#define TEXTURE_ATLAS_NAME "atlas"
+#define TEXTURE_ATLAS_RECTS_NAME "atlasRects"
+
+// Textures larger than this in either dimension are left out of atlases
+#define TEXTURE_ATLAS_MAX_TEXTURE_SIZE 64
+#define TEXTURE_ATLAS_MAX_SIZE 2048
+// Border around each texture, filled by repeating its edge texels so filtering does not bleed between neighbours
+#define TEXTURE_ATLAS_PADDING 1
+
+struct TextureAtlas {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+    std::vector<char> rects;
+};
+
+// Returns the configured group `path` belongs to, or an empty string.
+std::string GetTextureAtlasGroup(const std::string& path);
+
+// Queues an RGBA8 texture for the atlas of its group. Textures outside any group or too large are ignored.
+void AddAtlasTexture(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba);
+
+// Packs every queued texture, keyed by group, and clears the queue.
+std::map<std::string, TextureAtlas> PackTextureAtlases();
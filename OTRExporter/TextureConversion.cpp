@@ -0,0 +1,193 @@
+#include "TextureConversion.h"
+#include <algorithm>
+
+static size_t GetBitsPerPixel(N64TextureFormat format)
+{
+    switch (format) {
+        case N64TextureFormat::RGBA32:
+            return 32;
+        case N64TextureFormat::RGBA16:
+        case N64TextureFormat::IA16:
+            return 16;
+        case N64TextureFormat::CI8:
+        case N64TextureFormat::I8:
+        case N64TextureFormat::IA8:
+            return 8;
+        default:
+            return 4;
+    }
+}
+
+static inline uint8_t Expand5(uint8_t value)
+{
+    return (uint8_t)((value << 3) | (value >> 2));
+}
+
+static inline uint8_t Expand4(uint8_t value)
+{
+    return (uint8_t)((value << 4) | value);
+}
+
+static inline void ConvertRGBA16(const uint8_t* src, uint8_t* dst)
+{
+    uint16_t pixel = (uint16_t)((src[0] << 8) | src[1]);
+
+    dst[0] = Expand5((pixel >> 11) & 0x1F);
+    dst[1] = Expand5((pixel >> 6) & 0x1F);
+    dst[2] = Expand5((pixel >> 1) & 0x1F);
+    dst[3] = (pixel & 1) * 0xFF;
+}
+
+static inline void ConvertIA16(const uint8_t* src, uint8_t* dst)
+{
+    dst[0] = src[0];
+    dst[1] = src[0];
+    dst[2] = src[0];
+    dst[3] = src[1];
+}
+
+// Returns the 4 or 8 bit value of pixel `x` in a row
+static inline uint8_t GetIndex(const uint8_t* row, uint32_t x, bool is4Bit)
+{
+    if (!is4Bit)
+        return row[x];
+
+    return (x & 1) ? (row[x >> 1] & 0x0F) : (row[x >> 1] >> 4);
+}
+
+bool ConvertTextureToRGBA8(N64TextureFormat format, const uint8_t* data, size_t dataSize, uint32_t width,
+                           uint32_t height, const uint8_t* tlut, size_t tlutCount, N64TextureFormat tlutFormat,
+                           std::vector<uint8_t>& rgba)
+{
+    size_t rowSize = (width * GetBitsPerPixel(format) + 7) / 8;
+
+    if (data == nullptr || rowSize * height > dataSize)
+        return false;
+
+    bool isPalette = format == N64TextureFormat::CI4 || format == N64TextureFormat::CI8;
+
+    if (isPalette && (tlut == nullptr || tlutCount < (format == N64TextureFormat::CI4 ? 16 : 256)))
+        return false;
+
+    if (isPalette && tlutFormat != N64TextureFormat::RGBA16 && tlutFormat != N64TextureFormat::IA16)
+        return false;
+
+    rgba.resize((size_t)width * height * 4);
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = data + y * rowSize;
+        uint8_t* dst = &rgba[(size_t)y * width * 4];
+
+        switch (format) {
+            case N64TextureFormat::RGBA32:
+                for (uint32_t x = 0; x < width * 4; x++)
+                    dst[x] = src[x];
+                break;
+            case N64TextureFormat::RGBA16:
+                for (uint32_t x = 0; x < width; x++)
+                    ConvertRGBA16(&src[x * 2], &dst[x * 4]);
+                break;
+            case N64TextureFormat::CI4:
+            case N64TextureFormat::CI8:
+                if (tlutFormat == N64TextureFormat::IA16) {
+                    for (uint32_t x = 0; x < width; x++)
+                        ConvertIA16(&tlut[GetIndex(src, x, format == N64TextureFormat::CI4) * 2], &dst[x * 4]);
+                } else {
+                    for (uint32_t x = 0; x < width; x++)
+                        ConvertRGBA16(&tlut[GetIndex(src, x, format == N64TextureFormat::CI4) * 2], &dst[x * 4]);
+                }
+                break;
+            case N64TextureFormat::I4:
+            case N64TextureFormat::I8:
+                for (uint32_t x = 0; x < width; x++) {
+                    uint8_t i = GetIndex(src, x, format == N64TextureFormat::I4);
+
+                    if (format == N64TextureFormat::I4)
+                        i = Expand4(i);
+
+                    dst[x * 4 + 0] = i;
+                    dst[x * 4 + 1] = i;
+                    dst[x * 4 + 2] = i;
+                    dst[x * 4 + 3] = i;
+                }
+                break;
+            case N64TextureFormat::IA4:
+                for (uint32_t x = 0; x < width; x++) {
+                    uint8_t value = GetIndex(src, x, true);
+                    uint8_t i3 = value >> 1;
+                    uint8_t i = (uint8_t)((i3 << 5) | (i3 << 2) | (i3 >> 1));
+
+                    dst[x * 4 + 0] = i;
+                    dst[x * 4 + 1] = i;
+                    dst[x * 4 + 2] = i;
+                    dst[x * 4 + 3] = (value & 1) * 0xFF;
+                }
+                break;
+            case N64TextureFormat::IA8:
+                for (uint32_t x = 0; x < width; x++) {
+                    uint8_t i = Expand4(src[x] >> 4);
+
+                    dst[x * 4 + 0] = i;
+                    dst[x * 4 + 1] = i;
+                    dst[x * 4 + 2] = i;
+                    dst[x * 4 + 3] = Expand4(src[x] & 0x0F);
+                }
+                break;
+            case N64TextureFormat::IA16:
+                for (uint32_t x = 0; x < width; x++)
+                    ConvertIA16(&src[x * 2], &dst[x * 4]);
+                break;
+        }
+    }
+
+    return true;
+}
+
+std::vector<TextureMipLevel> GenerateMipChain(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
+{
+    std::vector<TextureMipLevel> levels;
+    const std::vector<uint8_t>* src = &rgba;
+    uint32_t srcWidth = width;
+    uint32_t srcHeight = height;
+
+    while (srcWidth > 1 || srcHeight > 1) {
+        TextureMipLevel level;
+        level.width = std::max(srcWidth / 2, 1u);
+        level.height = std::max(srcHeight / 2, 1u);
+        level.rgba.resize((size_t)level.width * level.height * 4);
+
+        for (uint32_t y = 0; y < level.height; y++) {
+            for (uint32_t x = 0; x < level.width; x++) {
+                uint32_t sum[4] = {};
+
+                for (uint32_t sy = 0; sy < 2; sy++) {
+                    for (uint32_t sx = 0; sx < 2; sx++) {
+                        uint32_t px = std::min(x * 2 + sx, srcWidth - 1);
+                        uint32_t py = std::min(y * 2 + sy, srcHeight - 1);
+                        const uint8_t* texel = &(*src)[((size_t)py * srcWidth + px) * 4];
+
+                        for (int c = 0; c < 3; c++)
+                            sum[c] += texel[c] * texel[3];
+
+                        sum[3] += texel[3];
+                    }
+                }
+
+                uint8_t* dst = &level.rgba[((size_t)y * level.width + x) * 4];
+
+                for (int c = 0; c < 3; c++)
+                    dst[c] = sum[3] != 0 ? (uint8_t)((sum[c] + sum[3] / 2) / sum[3]) : 0;
+
+                dst[3] = (uint8_t)((sum[3] + 2) / 4);
+            }
+        }
+
+        levels.push_back(std::move(level));
+
+        src = &levels.back().rgba;
+        srcWidth = levels.back().width;
+        srcHeight = levels.back().height;
+    }
+
+    return levels;
+}
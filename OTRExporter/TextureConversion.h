@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Conversion of N64 texture data to 32 bit RGBA (bytes in R, G, B, A order).
+//
+// The kernels are plain per-row loops over fixed size pixels without branches on the pixel data, which compilers
+// vectorize. Source data is the big endian N64 layout as stored in the ROM.
+
+enum class N64TextureFormat {
+    RGBA32,
+    RGBA16,
+    CI4,
+    CI8,
+    I4,
+    I8,
+    IA4,
+    IA8,
+    IA16,
+};
+
+// `tlut` holds big endian palette entries in `tlutFormat` (RGBA16 or IA16, as selected by G_TT_RGBA16 / G_TT_IA16)
+// and is only used by CI formats. Returns false if the source data or palette is too small for the given size, or the
+// palette format is not one of those two.
+bool ConvertTextureToRGBA8(N64TextureFormat format, const uint8_t* data, size_t dataSize, uint32_t width,
+                           uint32_t height, const uint8_t* tlut, size_t tlutCount, N64TextureFormat tlutFormat,
+                           std::vector<uint8_t>& rgba);
+
+struct TextureMipLevel {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+};
+
+// Box filters an RGBA8 image down to 1x1, halving each dimension per level (odd sizes round down and the last row
+// or column is clamped). Color is weighted by alpha so transparent texels do not bleed into their neighbours.
+// The base level is not included.
+std::vector<TextureMipLevel> GenerateMipChain(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height);
@@ -1,11 +1,135 @@
 #include "TextureExporter.h"
 #include "../ZAPD/ZFile.h"
+#include "TextureConversion.h"
+#include "BlockCompression.h"
+#include "TextureAtlas.h"
+#include "DisplayListExporter.h"
+#include "Main.h"
+
+static bool GetTextureFormat(TextureType type, N64TextureFormat& format)
+{
+	switch (type)
+	{
+		case TextureType::RGBA32bpp: format = N64TextureFormat::RGBA32; return true;
+		case TextureType::RGBA16bpp: format = N64TextureFormat::RGBA16; return true;
+		case TextureType::Palette4bpp: format = N64TextureFormat::CI4; return true;
+		case TextureType::Palette8bpp: format = N64TextureFormat::CI8; return true;
+		case TextureType::Grayscale4bpp: format = N64TextureFormat::I4; return true;
+		case TextureType::Grayscale8bpp: format = N64TextureFormat::I8; return true;
+		case TextureType::GrayscaleAlpha4bpp: format = N64TextureFormat::IA4; return true;
+		case TextureType::GrayscaleAlpha8bpp: format = N64TextureFormat::IA8; return true;
+		case TextureType::GrayscaleAlpha16bpp: format = N64TextureFormat::IA16; return true;
+		default: return false;
+	}
+}
+
+// Returns the N64 texture data. ROM textures read it from their file. Textures imported from a PNG (custom assets)
+// have no file and return the data the PNG was converted to, which needs Globals::buildRawTexture.
+static std::vector<uint8_t> GetTextureData(ZTexture* tex)
+{
+	if (tex->parent == nullptr)
+	{
+		std::string src = tex->GetBodySourceCode();
+
+		return std::vector<uint8_t>(src.begin(), src.end());
+	}
+
+	const auto& fileData = tex->parent->GetRawData();
+	auto start = fileData.begin() + tex->GetRawDataIndex();
+
+	return std::vector<uint8_t>(start, start + tex->GetRawDataSize());
+}
+
+// Converts the texture to RGBA8. CI textures use the TLUT ZAPD paired them with while parsing display lists and
+// are skipped when there is none. The palette format follows the TLUT's declared format (rgba16 or ia16).
+static bool ConvertToRGBA8(ZTexture* tex, const std::vector<uint8_t>& data, std::vector<uint8_t>& rgba)
+{
+	N64TextureFormat format;
+
+	if (!GetTextureFormat(tex->GetTextureType(), format))
+		return false;
+
+	std::vector<uint8_t> tlutData;
+	N64TextureFormat tlutFormat = N64TextureFormat::RGBA16;
+
+	if (tex->tlut != nullptr && tex->tlut->parent != nullptr)
+	{
+		if (!GetTextureFormat(tex->tlut->GetTextureType(), tlutFormat))
+			return false;
+
+		const auto& tlutFileData = tex->tlut->parent->GetRawData();
+		auto tlutStart = tlutFileData.begin() + tex->tlut->GetRawDataIndex();
+
+		tlutData.assign(tlutStart, tlutStart + tex->tlut->GetRawDataSize());
+	}
+
+	return ConvertTextureToRGBA8(format, data.data(), data.size(), tex->GetWidth(), tex->GetHeight(), tlutData.data(),
+	                             tlutData.size() / 2, tlutFormat, rgba);
+}
+
+void OTRExporter_Texture::SaveRGBA32(BinaryWriter* writer, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba)
+{
+	WriteHeader(nullptr, "", writer, static_cast<uint32_t>(Fast::ResourceType::Texture));
+
+	writer->Write((uint32_t)TextureType::RGBA32bpp);
+	writer->Write(width);
+	writer->Write(height);
+
+	writer->Write((uint32_t)rgba.size());
+	WriteArray(writer, rgba);
+}
 
 void OTRExporter_Texture::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZTexture* tex = (ZTexture*)res;
+
+	// Version 1 appends a set of optional sections after the version 0 data.
+	uint32_t sections = 0;
+	std::vector<uint8_t> rgba;
+	BlockFormat blockFormat = BlockFormat::BC1;
+	std::vector<uint8_t> blocks;
+	std::vector<TextureMipLevel> mips;
+	std::vector<uint8_t> data = GetTextureData(tex);
+
+	// Textures imported from a PNG have no file to resolve a path from, their asset path is passed as outPath
+	std::string atlasPath;
+
+	if (!atlasGroups.empty())
+		atlasPath = tex->parent == nullptr ? outPath.string() : OTRExporter_DisplayList::GetPathToRes(tex, tex->GetName());
+
+	bool atlasTexture = atlasPath != "" && GetTextureAtlasGroup(atlasPath) != "";
+
+	if ((rgba8Textures || blockCompressTextures || mipTextures || atlasTexture) && ConvertToRGBA8(tex, data, rgba))
+	{
+		if (atlasTexture)
+			AddAtlasTexture(atlasPath, tex->GetWidth(), tex->GetHeight(), rgba);
+
+		if (rgba8Textures)
+			sections |= TEX_SECTION_RGBA8;
+
+		if (mipTextures)
+		{
+			mips = GenerateMipChain(rgba, tex->GetWidth(), tex->GetHeight());
+
+			if (!mips.empty())
+				sections |= TEX_SECTION_MIPS;
+		}
+
+		if (blockCompressTextures)
+		{
+			blockFormat = ChooseBlockFormat(rgba);
+			blocks = EncodeBlocks(blockFormat, rgba, tex->GetWidth(), tex->GetHeight());
+
+			double psnr = ComputePSNR(rgba, DecodeBlocks(blockFormat, blocks, tex->GetWidth(), tex->GetHeight()));
+
+			if (psnr >= TEX_BLOCK_COMPRESSED_MIN_PSNR)
+				sections |= TEX_SECTION_BLOCK_COMPRESSED;
+			else
+				printf("Texture %s block compresses poorly (%.1f dB), keeping only the N64 data\n", tex->GetName().c_str(), psnr);
+		}
+	}
 	
-	WriteHeader(tex, outPath, writer, static_cast<uint32_t>(Fast::ResourceType::Texture));
+	WriteHeader(tex, outPath, writer, static_cast<uint32_t>(Fast::ResourceType::Texture), sections != 0 ? 1 : 0);
 
 	auto start = std::chrono::steady_clock::now();
 
@@ -17,10 +141,38 @@ void OTRExporter_Texture::Save(ZResource* res, const fs::path& outPath, BinaryWr
 
 	writer->Write((uint32_t)tex->GetRawDataSize());
 
-	if (tex->parent != nullptr) {
- 		auto data = tex->parent->GetRawData();
- 		writer->Write((char*)data.data() + tex->GetRawDataIndex(), tex->GetRawDataSize());
- 	}
+	WriteArray(writer, data);
+
+	if (sections != 0)
+	{
+		writer->Write(sections);
+
+		if (sections & TEX_SECTION_RGBA8)
+		{
+			writer->Write((uint32_t)rgba.size());
+			WriteArray(writer, rgba);
+		}
+
+		if (sections & TEX_SECTION_BLOCK_COMPRESSED)
+		{
+			writer->Write((uint32_t)blockFormat);
+			writer->Write((uint32_t)blocks.size());
+			WriteArray(writer, blocks);
+		}
+
+		if (sections & TEX_SECTION_MIPS)
+		{
+			writer->Write((uint32_t)mips.size());
+
+			for (const auto& level : mips)
+			{
+				writer->Write(level.width);
+				writer->Write(level.height);
+				writer->Write((uint32_t)level.rgba.size());
+				WriteArray(writer, level.rgba);
+			}
+		}
+	}
 
 	auto end = std::chrono::steady_clock::now();
 	size_t diff = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
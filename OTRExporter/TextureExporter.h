@@ -5,8 +5,18 @@
 #include "Exporter.h"
 #include <Utils/BinaryWriter.h>
 
+// Optional sections written after the version 0 data of a version 1 texture
+#define TEX_SECTION_RGBA8 (1 << 0)
+#define TEX_SECTION_BLOCK_COMPRESSED (1 << 1)
+#define TEX_SECTION_MIPS (1 << 2)
+
+// Block compressed data is only kept if it decodes back to within this quality of the RGBA8 texture
+#define TEX_BLOCK_COMPRESSED_MIN_PSNR 30.0
+
 class OTRExporter_Texture : public OTRExporter
 {
 public:
+	// Writes an RGBA32 texture resource for pixels that do not come from a ZTexture, such as texture atlases
+	static void SaveRGBA32(BinaryWriter* writer, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba);
 	virtual void Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer) override;
 };
\ No newline at end of file
@@ -1,44 +1,70 @@
 #include "VtxExporter.h"
 #include <libultraship/bridge.h>
 #include "VersionInfo.h"
+#include "Main.h"
 
 
+OTRVtx OTRExporter_Vtx::PackVtx(const ZVtx* vtx)
+{
+	OTRVtx packed;
+
+	packed.x = vtx->x;
+	packed.y = vtx->y;
+	packed.z = vtx->z;
+	packed.flag = vtx->flag;
+	packed.s = vtx->s;
+	packed.t = vtx->t;
+	packed.r = vtx->r;
+	packed.g = vtx->g;
+	packed.b = vtx->b;
+	packed.a = vtx->a;
+
+	return packed;
+}
+
+void OTRExporter_Vtx::WriteVtxList(BinaryWriter* writer, const std::vector<ZResource*>& vtxList, size_t count)
+{
+	std::vector<OTRVtx> packed;
+	packed.reserve(count);
+
+	for (size_t i = 0; i < count; i++)
+		packed.push_back(PackVtx((ZVtx*)vtxList[i]));
+
+	WriteArray(writer, packed);
+}
+
+void OTRExporter_Vtx::WriteRuntimeVtxList(BinaryWriter* writer, const std::vector<OTRVtx>& vertices)
+{
+	writer->Write((uint32_t)vertices.size());
+
+	while (writer->GetBaseAddress() % VTX_RUNTIME_LAYOUT_ALIGNMENT != 0)
+		writer->Write((uint8_t)0);
+
+	WriteArray(writer, vertices);
+}
+
 void OTRExporter_Vtx::SaveArr(ZResource* res, const fs::path& outPath, const std::vector<ZResource*>& vec, BinaryWriter* writer)
 {
 	WriteHeader(res, outPath, writer, static_cast<uint32_t>(Fast::ResourceType::Vertex));
-	
-	for (auto& res: vec) {
-		ZVtx* vtx = (ZVtx*)res;
-		writer->Write(vtx->x);
-		writer->Write(vtx->y);
-		writer->Write(vtx->z);
-		writer->Write(vtx->flag);
-		writer->Write(vtx->s);
-		writer->Write(vtx->t);
-		writer->Write(vtx->r);
-		writer->Write(vtx->g);
-		writer->Write(vtx->b);
-		writer->Write(vtx->a);
-	}
 
+	WriteVtxList(writer, vec, vec.size());
 }
 
 void OTRExporter_Vtx::Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer)
 {
 	ZVtx* vtx = (ZVtx*)res;
 
+	if (vtxRuntimeLayout)
+	{
+		WriteHeader(res, outPath, writer, static_cast<uint32_t>(Fast::ResourceType::Vertex), VTX_RUNTIME_LAYOUT_VERSION);
+		WriteRuntimeVtxList(writer, { PackVtx(vtx) });
+		return;
+	}
+
 	WriteHeader(res, outPath, writer, static_cast<uint32_t>(Fast::ResourceType::Vertex));
 
 	writer->Write((uint32_t)1); //Yes I'm hard coding it to one, it *should* be fine.
 
-	writer->Write(vtx->x);
-	writer->Write(vtx->y);
-	writer->Write(vtx->z);
-	writer->Write(vtx->flag);
-	writer->Write(vtx->s);
-	writer->Write(vtx->t);
-	writer->Write(vtx->r);
-	writer->Write(vtx->g);
-	writer->Write(vtx->b);
-	writer->Write(vtx->a);
+	OTRVtx packed = PackVtx(vtx);
+	WriteArray(writer, &packed, 1);
 }
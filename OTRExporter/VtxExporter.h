@@ -5,9 +5,28 @@
 #include "Exporter.h"
 #include <Utils/BinaryWriter.h>
 
+// A single vertex as stored in the archive, laid out like the game's Vtx_t
+struct OTRVtx
+{
+	int16_t x, y, z;
+	uint16_t flag;
+	int16_t s, t;
+	uint8_t r, g, b, a;
+};
+
+static_assert(sizeof(OTRVtx) == 16, "OTRVtx must match the 16 byte Vtx_t layout");
+
+// Version 1 of vertex resources stores the vertex count followed by the Vtx array, padded so the
+// array starts on a 16 byte boundary. The runtime can then use the data as is.
+#define VTX_RUNTIME_LAYOUT_VERSION 1
+#define VTX_RUNTIME_LAYOUT_ALIGNMENT 16
+
 class OTRExporter_Vtx : public OTRExporter
 {
 public:
+	static OTRVtx PackVtx(const ZVtx* vtx);
+	static void WriteVtxList(BinaryWriter* writer, const std::vector<ZResource*>& vtxList, size_t count);
+	static void WriteRuntimeVtxList(BinaryWriter* writer, const std::vector<OTRVtx>& vertices);
 	void SaveArr(ZResource* res, const fs::path& outPath, const std::vector<ZResource*>&, BinaryWriter* writer);
 	virtual void Save(ZResource* res, const fs::path& outPath, BinaryWriter* writer) override;
 };
\ No newline at end of file